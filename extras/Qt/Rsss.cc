@@ -3,6 +3,7 @@
 #include "RsssCrc16.h"
 
 #include <errno.h>
+#include <algorithm>
 #include <unistd.h>
 
 #define CRC8_SEED    0x78
@@ -19,10 +20,19 @@ RSSS::RSSS(QSerialPort *s, bool t):
   _writeSync(0),
   _readCrc(0),
   _writeCrc(0),
+  _lastByte(),
+  _lastWrite(),
+  _timeout(0),
+  _heartbeat(0),
+  _stage(),
+  _stagedAt(),
+  _stageSize(0),
+  _cadence(0),
   _remain(0),
   _hold(0),
   _addTail(t),
-  _valid(!t) {}
+  _valid(!t),
+  _truncated(false) {}
 
 
 RSSS::~RSSS() {
@@ -45,6 +55,12 @@ void RSSS::reset(QSerialPort *serial, bool t) {
   _remain = 0;
   _addTail = t;
   _valid = !t;
+  _truncated = false;
+  _stage.clear();
+  _stageSize = 0; // back to a region per write()
+  _cadence = 0;
+  _lastByte.invalidate();
+  _lastWrite.invalidate();
 }
 
 
@@ -59,7 +75,11 @@ qint64 RSSS::bytesAvailable() {
   // was a synchronization point was found?
   if(_readSync > 0) {
     int avail = _serial->bytesAvailable();
-    retVal =  _readSync <= avail ? _readSync : avail;
+    retVal = _readSync <= avail ? _readSync : avail;
+
+    if(!avail && _stalled()) {
+      retVal = 0;
+    }
   }
 
   return retVal;
@@ -85,6 +105,8 @@ qint64 RSSS::read(char *data, qint64 length) {
   if(_addTail && _remain != 0) {
     if(_serial->bytesAvailable() >= _remain) {
       if(auto count = _serial->read(reinterpret_cast<char *>(&_last[2 - _remain]), _remain); count > 0) {
+        _lastByte.restart();
+
         if(!(_remain -= count)) {
           _valid = !calcCrc16(&_last[0], 2, _readCrc);
           *data = _hold;
@@ -92,6 +114,9 @@ qint64 RSSS::read(char *data, qint64 length) {
         }
       }
     }
+    else {
+      _stalled();
+    }
 
     return 0; // didn't read enough to validate CRC
   }
@@ -104,6 +129,8 @@ qint64 RSSS::read(char *data, qint64 length) {
 
   if(_readSync > 0) {
     if(auto count = _serial->read(data, std::min(length, _readSync)); count > 0) {
+      _lastByte.restart();
+
       if(_addTail) {
         _readCrc = calcCrc16(reinterpret_cast<uint8_t *>(data), count, _readCrc);
       }
@@ -119,6 +146,9 @@ qint64 RSSS::read(char *data, qint64 length) {
     else if(count < 0) {
       retVal = count;
     }
+    else {
+      _stalled();
+    }
   }
 
   return retVal;
@@ -131,6 +161,10 @@ qint64 RSSS::write(const QByteArray &buffer) {
 
 
 qint64 RSSS::write(const char *data, qint64 length) {
+  if(_stageSize > 0) {
+    return _stream(data, length);
+  }
+
   int retVal = 0;
   auto count = length;
 
@@ -140,6 +174,8 @@ qint64 RSSS::write(const char *data, qint64 length) {
 
   if(_writeSync > 0) {
     if(auto sent = _serial->write(data, std::min(count, _writeSync)); sent > 0) {
+      _lastWrite.restart();
+
       // update the written CRC if required
       if(_addTail) {
         _writeCrc = rsss::calcCrc16(reinterpret_cast<const uint8_t *>(data), sent, _writeCrc);
@@ -178,6 +214,7 @@ qint64 RSSS::write(const char *data, qint64 length) {
     }
 
     if(auto sent = _serial->write(data, count); sent > 0) {
+      _lastWrite.restart();
       _writeSync -= sent;
       retVal += sent;
 
@@ -209,6 +246,84 @@ failure:
 }
 
 
+bool RSSS::setCadence(int bytes, int ms) {
+  if(_writeSync > 0 || !flush()) {
+    return false; // inside a region, or the staged bytes didn't go out
+  }
+
+  _stageSize = std::clamp(bytes, 0, 0xFFFF);
+  _cadence = ms;
+  _stage.clear();
+  _stage.reserve(_stageSize);
+  return true;
+}
+
+
+bool RSSS::flush() {
+  if(_stage.isEmpty()) {
+    return true;
+  }
+
+  if(!_serial || !_emitSync(_stage.size())) {
+    return false;
+  }
+
+  _serial->write(_stage);
+  if(_addTail) {
+    _writeCrc = calcCrc16(reinterpret_cast<const uint8_t *>(_stage.constData()), _stage.size(), _writeCrc);
+    uint8_t buffer[2] = { static_cast<uint8_t>( _writeCrc       & 0xFF),
+                          static_cast<uint8_t>((_writeCrc >> 8) & 0xFF) };
+    _serial->write(reinterpret_cast<char *>(&buffer[0]), 2); // write the tail bytes
+  }
+
+  _stage.clear();
+  return true;
+}
+
+
+int RSSS::tick() {
+  if(!_stage.isEmpty() && _cadence && _stagedAt.hasExpired(_cadence)) {
+    return flush() ? 1 : -1;
+  }
+
+  if(!_stage.isEmpty() || !_heartbeat || !_serial || _writeSync > 0 || (_lastWrite.isValid() && !_lastWrite.hasExpired(_heartbeat))) {
+    return 0; // not due, or inside a region where a header would be taken for payload
+  }
+
+  return _emitSync(0) ? 1 : -1;
+}
+
+
+// stage bytes until a whole region of them is there, or the oldest has
+// waited for the cadence, and send them as one region
+qint64 RSSS::_stream(const char *data, qint64 length) {
+  if(!_stage.isEmpty() && _cadence && _stagedAt.hasExpired(_cadence) && !flush()) {
+    return -1;
+  }
+
+  qint64 taken = 0;
+  while(taken < length) {
+    if(_stage.size() == _stageSize && !flush()) {
+      return taken ? taken : -1;
+    }
+
+    if(_stage.isEmpty()) {
+      _stagedAt.start();
+    }
+
+    auto count = std::min<qint64>(length - taken, _stageSize - _stage.size());
+    _stage.append(data + taken, count);
+    taken += count;
+  }
+
+  if(_stage.size() == _stageSize) {
+    flush(); // a failure shows up with the next write
+  }
+
+  return taken;
+}
+
+
 qint64 RSSS::_findSync() {
   qint64 retVal = 0;
 
@@ -219,7 +334,9 @@ qint64 RSSS::_findSync() {
       retVal = _last[1] | (_last[2] << 8);
       memset(&_last[0], 0, 4);
       _readCrc = CRC16_SEED;
-      _valid = !_addTail;
+      _valid = !_addTail || !retVal; // a heartbeat has no tail to check
+      _truncated = false;
+      _lastByte.start();
       break;
     }
   }
@@ -228,6 +345,22 @@ qint64 RSSS::_findSync() {
 }
 
 
+// drop the current region once the sender went quiet for too long, so the
+// next frame isn't taken for the rest of this one
+bool RSSS::_stalled() {
+  if(!_timeout || !_lastByte.isValid() || !_lastByte.hasExpired(_timeout)) {
+    return false;
+  }
+
+  _readSync = 0;
+  _remain = 0;
+  _hold = 0;
+  _valid = false;
+  _truncated = true;
+  return true;
+}
+
+
 bool RSSS::_emitSync(qint64 length) {
   length = std::min(length, 0xFFFFLL);
 
@@ -238,6 +371,7 @@ bool RSSS::_emitSync(qint64 length) {
 
   if(_serial->write(reinterpret_cast<char *>(&packet[0]), 4) == 4) {
     _writeCrc = CRC16_SEED;
+    _lastWrite.restart();
     return true;
   }
 
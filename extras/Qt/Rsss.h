@@ -4,6 +4,7 @@
 #include <array>
 #include <cstdint>
 #include <QSerialPort>
+#include <QElapsedTimer>
 
 
 namespace rsss {
@@ -21,9 +22,31 @@ class RSSS {
     qint64     read(char *, qint64); // find a synchronization point and then read bytes
     bool       crcValid() { return _valid; }
 
+    // give up on a region once no byte arrived for this many milliseconds,
+    // 0 (the default) waits forever; truncated() then stays true until the
+    // next synchronization point
+    void setFrameTimeout(int ms) { _timeout = ms; }
+    bool truncated() const { return _truncated; }
+
     qint64 write(const QByteArray &); // emit a synchronization point and then write bytes
     qint64 write(const char *, qint64); // emit a synchronization point and then write bytes
 
+    // send an empty synchronization point whenever nothing was written for
+    // this many milliseconds, 0 (the default) turns it off; heartbeats only
+    // go out from tick(), drive it from a QTimer
+    void setHeartbeat(int ms) { _heartbeat = ms; }
+    int  tick();
+
+    // stream mode: instead of a region per write(), written bytes are staged
+    // and sent as one region once that many have gathered, or once the oldest
+    // has waited ms milliseconds, however the caller slices its writes. With
+    // ms = 0 only the byte count and flush() send them, otherwise write() and
+    // tick() check the time too. bytes = 0 (the default) turns it off.
+    // Anything staged is sent first; returns false, changing nothing, inside
+    // a region or when that fails
+    bool setCadence(int bytes, int ms = 0);
+    bool flush(); // send the staged bytes now
+
     operator bool() const { return !!_serial; }
 
     explicit operator       QSerialPort *()       { return _serial; }
@@ -36,12 +59,23 @@ class RSSS {
     qint64                       _writeSync;
     quint16                      _readCrc;
     quint16                      _writeCrc;
+    QElapsedTimer                _lastByte;
+    QElapsedTimer                _lastWrite;
+    int                          _timeout;
+    int                          _heartbeat;
+    QByteArray                   _stage;
+    QElapsedTimer                _stagedAt;
+    int                          _stageSize;
+    int                          _cadence;
     qint8                        _remain;
     char                         _hold;
     bool                         _addTail;
     bool                         _valid;
+    bool                         _truncated;
 
+    bool   _stalled();
     qint64 _findSync();
+    qint64 _stream(const char *, qint64);
     bool   _emitSync(qint64);
 };
 
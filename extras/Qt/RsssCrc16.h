@@ -1,16 +1,53 @@
 #ifndef RSSS_CRC16
 #  define RSSS_CRC16
 
-#  include <cstdint>
+#  include "RsssCrc.h"
 
 
 namespace rsss {
 
-  uint16_t calcCrc16(const uint8_t *, int, uint16_t);
-  uint16_t appendCrc16(uint8_t *, int, uint16_t);
-  bool     validateCrc16(const uint8_t *, int, uint16_t);
+  class ThreadPool;
+
+  // below this length the byte-wise loop is inlined into the caller
+  constexpr int CRC16_WIDE_MINIMUM = 32;
+
+  uint16_t calcCrc16Wide(const uint8_t *, int, uint16_t);
+
+
+  inline uint16_t calcCrc16(const uint8_t *data, int len, uint16_t crc) {
+    if(len >= CRC16_WIDE_MINIMUM) {
+      return calcCrc16Wide(data, len, crc);
+    }
+
+    return len > 0 ? Crc16::update(crc, data, len) : crc;
+  }
+
+
+  inline uint16_t appendCrc16(uint8_t *data, int len, uint16_t crc) {
+    crc = calcCrc16(data, len, crc);
+
+    data[len    ] =  crc       & 0xFF;
+    data[len + 1] = (crc >> 8) & 0xFF;
+
+    return crc;
+  }
+
+
+  inline bool validateCrc16(const uint8_t *data, int len, uint16_t crc) {
+    return !calcCrc16(data, len, crc);
+  }
+
+
+  // merge the CRCs of two adjacent blocks that were both started from seed
+  inline uint16_t crc16Combine(uint16_t first, uint16_t second, std::size_t secondLen, uint16_t seed) {
+    return Crc16::combine(first, second, secondLen, seed);
+  }
+
+
+  // split large buffers across a thread pool and combine the partial CRCs
+  uint16_t calcCrc16Parallel(const uint8_t *, std::size_t, uint16_t);
+  uint16_t calcCrc16Parallel(const uint8_t *, std::size_t, uint16_t, ThreadPool &);
 
 }
 
 #endif /* RSSS_CRC16 */
-
@@ -0,0 +1,106 @@
+#ifndef RSSS_BENCH_H
+#  define RSSS_BENCH_H
+
+#  include <chrono>
+#  include <cstdio>
+#  include <cstdint>
+#  include <cstring>
+
+#  if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCH_HAS_TSC 1
+#  else
+#    define BENCH_HAS_TSC 0
+#  endif
+
+
+namespace rsss {
+namespace bench {
+
+// sizes reported by every suite, the last one is the largest RSSS region
+static const std::size_t SIZES[] = { 1, 4, 16, 64, 256, 1024, 4096, 16384, 65535 };
+
+
+struct Sample {
+  double        seconds;
+  std::uint64_t cycles;
+  std::uint64_t count;
+};
+
+
+inline std::uint64_t cycles() {
+#  if BENCH_HAS_TSC
+  return __rdtsc();
+#  else
+  return 0;
+#  endif
+}
+
+
+// keeps results alive without the compiler proving them unused
+inline void consume(std::uint64_t value) {
+  static volatile std::uint64_t sink;
+  sink = sink + value;
+}
+
+
+// repeat fn() in growing batches until at least minimum seconds have passed
+template<typename F>
+Sample measure(F &&fn, double minimum = 0.2) {
+  Sample result{ 0.0, 0, 0 };
+
+  for(std::uint64_t batch = 1; result.seconds < minimum; batch *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    auto tsc   = cycles();
+
+    for(std::uint64_t i = 0; i < batch; ++i) {
+      fn();
+    }
+
+    result.cycles  += cycles() - tsc;
+    result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.count   += batch;
+  }
+
+  return result;
+}
+
+
+inline bool selected(const char *name, int argc, char **argv) {
+  if(argc < 2) {
+    return true;
+  }
+
+  for(int i = 1; i < argc; ++i) {
+    if(strstr(name, argv[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+inline void header() {
+  printf("%-28s %8s %12s %12s %14s\n", "benchmark", "bytes", "MB/s", "cycles/B", "calls/s");
+}
+
+
+// cycles are TSC ticks, which run at the nominal rather than the boosted clock
+inline void report(const char *name, std::size_t bytes, const Sample &s) {
+  const double calls = s.count / s.seconds;
+
+  if(BENCH_HAS_TSC) {
+    printf("%-28s %8zu %12.1f %12.3f %14.0f\n", name, bytes, calls * bytes / 1e6,
+           static_cast<double>(s.cycles) / (static_cast<double>(s.count) * bytes), calls);
+  }
+  else {
+    printf("%-28s %8zu %12.1f %12s %14.0f\n", name, bytes, calls * bytes / 1e6, "-", calls);
+  }
+}
+
+}
+}
+
+
+#endif /* RSSS_BENCH_H */
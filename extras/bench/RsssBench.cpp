@@ -0,0 +1,297 @@
+// Microbenchmarks for the CRC kernels and the POSIX framer, see README.md for
+// the build command. Any arguments restrict the run to benchmarks whose name contains one of them.
+
+#include "Bench.h"
+
+#include "RSSS.h"
+#include "RsssCrc8.h"
+#include "RsssCrc16.h"
+#include "RsssCrc32.h"
+#include "RsssCrc32c.h"
+#include "RsssSync.h"
+#include "RsssDecoder.h"
+
+#include <vector>
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+
+using namespace rsss;
+using namespace rsss::bench;
+
+
+static void crcSuite(int argc, char **argv) {
+  std::vector<std::uint8_t> data(SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1]);
+  std::mt19937 rng(1);
+  for(auto &byte: data) {
+    byte = static_cast<std::uint8_t>(rng());
+  }
+
+  for(auto size: SIZES) {
+    auto len = static_cast<int>(size);
+
+    if(selected("calcCrc8", argc, argv)) {
+      report("calcCrc8", size, measure([&]() { consume(calcCrc8(data.data(), len, 0x78)); }));
+    }
+
+    if(selected("calcCrc16", argc, argv)) {
+      report("calcCrc16", size, measure([&]() { consume(calcCrc16(data.data(), len, 0x8795)); }));
+    }
+
+    if(selected("calculateCrc32", argc, argv)) {
+      report("calculateCrc32", size, measure([&]() { consume(calculateCrc32(data.data(), size, 0)); }));
+    }
+
+    if(selected("calcCrc32c", argc, argv)) {
+      report("calcCrc32c", size, measure([&]() { consume(calcCrc32c(data.data(), size, 0)); }));
+    }
+  }
+}
+
+
+static void syncSuite(int argc, char **argv) {
+  std::vector<std::uint8_t> noise(SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1]);
+  std::vector<std::uint8_t> markers(noise.size(), 0xAA);
+  std::mt19937 rng(4);
+  for(auto &byte: noise) {
+    byte = static_cast<std::uint8_t>(rng());
+  }
+
+  // no valid header anywhere, so every scan covers the whole buffer
+  for(std::size_t i = 0; i + 4 <= noise.size(); ++i) {
+    if(noise[i] == 0xAA && (validateCrc8(&noise[i], 4, 0x78) || validateCrc8(&noise[i], 4, 0x87))) {
+      noise[i] = 0;
+    }
+  }
+
+  for(auto size: SIZES) {
+    if(selected("scanSync noise", argc, argv)) {
+      report("scanSync noise", size, measure([&]() { consume(scanSync(noise.data(), size, 0x78, 0x87)); }));
+    }
+
+    if(selected("scanSync markers", argc, argv)) {
+      report("scanSync markers", size, measure([&]() { consume(scanSync(markers.data(), size, 0x78, 0x87)); }));
+    }
+  }
+}
+
+
+// one frame written and read back through a socket pair on this thread
+static bool roundTrip(RSSS &writer, RSSS &reader, const std::uint8_t *data, std::uint8_t *out, std::uint16_t size) {
+  if(writer.write(data, size) != size) {
+    return false;
+  }
+
+  for(int got = 0, idle = 0; got < size; ) {
+    if(auto count = reader.read(&out[got], static_cast<std::uint16_t>(size - got)); count > 0) {
+      got += count;
+    }
+    else if(count < 0 || ++idle > 1000) {
+      return false;
+    }
+  }
+
+  return reader.crcValid();
+}
+
+
+// the same with the payload left in the reader's buffer
+static bool viewTrip(RSSS &writer, RSSS &reader, const std::uint8_t *data, std::uint16_t size) {
+  if(writer.write(data, size) != size) {
+    return false;
+  }
+
+  FrameView frame;
+  for(int idle = 0; ; ) {
+    if(auto result = reader.readFrame(frame); result > 0) {
+      break;
+    }
+    else if(result < 0 || ++idle > 1000) {
+      return false;
+    }
+  }
+
+  consume(frame.payload.data[frame.payload.size - 1]);
+  reader.release();
+  return frame.valid && frame.payload.size == size;
+}
+
+
+static void framerSuite(int argc, char **argv) {
+  static const struct { const char *name; Tail tail; bool view; } MODES[] = {
+    { "RSSS round trip",        Tail::None,   false },
+    { "RSSS round trip crc16",  Tail::Crc16,  false },
+    { "RSSS round trip crc32c", Tail::Crc32c, false },
+    { "RSSS frame view",        Tail::None,   true  },
+    { "RSSS frame view crc16",  Tail::Crc16,  true  },
+    { "RSSS frame view crc32c", Tail::Crc32c, true  },
+  };
+
+  std::vector<std::uint8_t> data(0xFFFF), out(0xFFFF);
+  std::mt19937 rng(2);
+  for(auto &byte: data) {
+    byte = static_cast<std::uint8_t>(rng());
+  }
+
+  for(auto &mode: MODES) {
+    if(!selected(mode.name, argc, argv)) {
+      continue;
+    }
+
+    int fds[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      perror("socketpair");
+      return;
+    }
+
+    int buffer = 1 << 20;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    RSSS writer(fds[0], mode.tail), reader(fds[1], mode.tail);
+    for(auto size: SIZES) {
+      bool ok = true;
+      auto sample = measure([&]() {
+        ok = (mode.view ? viewTrip(writer, reader, data.data(), static_cast<std::uint16_t>(size))
+                        : roundTrip(writer, reader, data.data(), out.data(), static_cast<std::uint16_t>(size))) && ok;
+      });
+
+      if(ok) {
+        report(mode.name, size, sample);
+      }
+      else {
+        printf("%-28s %8zu failed\n", mode.name, size);
+      }
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+
+
+// the write side alone, into /dev/null so only framing and syscalls count.
+// Batches hand 64 frames to writeFrames() at a time, calls/s is frames/s
+static void writerSuite(int argc, char **argv) {
+  static const struct { const char *name; Tail tail; bool batch; } MODES[] = {
+    { "RSSS write",              Tail::None,  false },
+    { "RSSS write crc16",        Tail::Crc16, false },
+    { "RSSS writeFrames",        Tail::None,  true  },
+    { "RSSS writeFrames crc16",  Tail::Crc16, true  },
+  };
+
+  constexpr std::size_t BATCH = 64;
+
+  std::vector<std::uint8_t> data(0xFFFF);
+  std::mt19937 rng(6);
+  for(auto &byte: data) {
+    byte = static_cast<std::uint8_t>(rng());
+  }
+
+  for(auto &mode: MODES) {
+    if(!selected(mode.name, argc, argv)) {
+      continue;
+    }
+
+    int fd = open("/dev/null", O_WRONLY);
+    if(fd < 0) {
+      perror("/dev/null");
+      return;
+    }
+
+    RSSS writer(fd, mode.tail);
+    for(auto size: SIZES) {
+      std::vector<Span> frames(BATCH, Span{ data.data(), size });
+      bool ok = true;
+
+      auto sample = measure([&]() {
+        if(mode.batch) {
+          ok = writer.writeFrames(frames) == static_cast<int>(BATCH) && ok;
+          return;
+        }
+
+        for(auto &frame: frames) {
+          ok = writer.write(frame.data, static_cast<std::uint16_t>(frame.size)) == static_cast<int>(frame.size) && ok;
+        }
+      });
+
+      sample.count *= BATCH;
+      if(ok) {
+        report(mode.name, size, sample);
+      }
+      else {
+        printf("%-28s %8zu failed\n", mode.name, size);
+      }
+    }
+
+    close(fd);
+  }
+}
+
+
+// the decoder fed one encoded frame per call, straight from memory
+static void decoderSuite(int argc, char **argv) {
+  struct Discard: Decoder::Sink {
+    void frameBegin(std::uint16_t length) override { consume(length); }
+    void frameData(const std::uint8_t *data, std::size_t size) override { consume(data[size - 1]); }
+    void frameEnd(bool valid) override { consume(valid); }
+  };
+
+  static const struct { const char *name; Tail tail; } MODES[] = {
+    { "Decoder",        Tail::None   },
+    { "Decoder crc16",  Tail::Crc16  },
+    { "Decoder crc32c", Tail::Crc32c },
+  };
+
+  std::vector<std::uint8_t> data(0xFFFF);
+  std::mt19937 rng(5);
+  for(auto &byte: data) {
+    byte = static_cast<std::uint8_t>(rng());
+  }
+
+  for(auto &mode: MODES) {
+    if(!selected(mode.name, argc, argv)) {
+      continue;
+    }
+
+    int fds[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      perror("socketpair");
+      return;
+    }
+
+    int buffer = 1 << 20;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+
+    RSSS writer(fds[0], mode.tail);
+    Discard sink;
+    Decoder decoder(sink, mode.tail);
+    std::vector<std::uint8_t> frame(0xFFFF + 8);
+
+    for(auto size: SIZES) {
+      // let the writer encode the frame, then take it back off the socket
+      writer.write(data.data(), static_cast<std::uint16_t>(size));
+      auto length = ::read(fds[1], frame.data(), frame.size());
+
+      report(mode.name, size, measure([&]() { decoder.feed(frame.data(), length); }));
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+
+
+int main(int argc, char **argv) {
+  header();
+  crcSuite(argc, argv);
+  syncSuite(argc, argv);
+  decoderSuite(argc, argv);
+  writerSuite(argc, argv);
+  framerSuite(argc, argv);
+  return 0;
+}
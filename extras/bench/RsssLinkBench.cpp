@@ -0,0 +1,378 @@
+// Goodput and resync latency of the POSIX framers, sync headers and COBS,
+// over a simulated noisy link, and the latency of urgent frames behind bulk
+// traffic with and without rsss::Pacer, see README.md for the build command.
+// Any arguments restrict the run to rows whose name contains one of them.
+
+#include "Bench.h"
+
+#include "RSSS.h"
+#include "RsssCobs.h"
+#include "RsssPacer.h"
+#include "RsssLinkSim.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+using namespace rsss;
+using namespace rsss::bench;
+
+using Clock = std::chrono::steady_clock;
+
+
+static const std::uint32_t BAUD     = 1000000;
+static const int           FRAME    = 256;
+static const double        DURATION = 2.0;
+
+static const std::uint32_t PACED_BAUD = 115200;
+static const int           URGENT     = 16;  // bytes in an urgent frame, bulk ones are FRAME bytes
+static const int           URGENT_GAP = 100; // milliseconds between urgent frames
+static const int           PACE_DELAY = 20;  // milliseconds of bytes the pacer lets queue up
+static const std::size_t   DEEP_QUEUE = 1 << 20; // a driver queue that sits on seconds of bulk
+
+
+struct Result {
+  std::uint64_t sent;
+  std::uint64_t good;       // intact and accepted
+  std::uint64_t rejected;   // failed the CRC tail
+  std::uint64_t undetected; // damaged but accepted
+  std::uint64_t missing;    // sequence numbers never seen
+  std::uint64_t gaps;
+  double        resync;     // summed over all gaps, in seconds
+  double        worst;
+  double        seconds;
+};
+
+
+// payloads carry a sequence number followed by bytes derived from all of it,
+// so damage to any part of the frame shows up as a mismatch
+static void fill(std::uint8_t *frame, std::uint32_t seq) {
+  const std::uint32_t hash = seq * 2654435761U;
+
+  memcpy(frame, &seq, sizeof(seq));
+  for(int i = sizeof(seq); i < FRAME; ++i) {
+    frame[i] = static_cast<std::uint8_t>((hash >> (i % 4 * 8)) + i * 7);
+  }
+}
+
+
+static bool intact(const std::uint8_t *frame, int length, std::uint32_t &seq) {
+  std::uint8_t expected[FRAME];
+
+  if(length != FRAME) {
+    return false;
+  }
+
+  memcpy(&seq, frame, sizeof(seq));
+  fill(expected, seq);
+  return !memcmp(frame, expected, FRAME);
+}
+
+
+template<typename Framer>
+static Result run(const LinkModel &model, Tail tail) {
+  LinkSim link(model);
+  Result result{};
+  std::atomic<bool> stop{ false }, done{ false };
+
+  std::thread writer([&]() {
+    Framer rsss(link.end(0), tail);
+    std::uint8_t frame[FRAME];
+
+    for(std::uint32_t seq = 0; !stop; ++seq) {
+      fill(frame, seq);
+      if(rsss.write(frame, FRAME) != FRAME) {
+        break;
+      }
+      result.sent = seq + 1;
+    }
+
+    done = true;
+  });
+
+  const int fd = link.end(1);
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  Framer rsss(fd, tail);
+  rsss.setMaxLength(FRAME); // every frame has the same size, anything longer is noise
+
+  std::uint8_t frame[FRAME];
+  std::uint32_t expected = 0;
+  int got = 0;
+
+  const int checked  = FRAME + (tail == Tail::Crc32c ? 4 : tail == Tail::Crc16 ? 2 : 0);
+  const int overhead = checked - FRAME + (std::is_same_v<Framer, Cobs> ? checked / 254 + 2 : 4);
+  const double period = (FRAME + overhead) * 10.0 / model.baud;
+  const auto start = Clock::now();
+  auto lastGood = start;
+
+  for(auto now = start; now - start < std::chrono::duration<double>(DURATION); now = Clock::now()) {
+    pollfd wait{ fd, POLLIN, 0 };
+    poll(&wait, 1, 10);
+
+    for(int count; (count = rsss.read(&frame[got], static_cast<std::uint16_t>(FRAME - got))) > 0; ) {
+      if((got += count) < FRAME && rsss.remaining()) {
+        continue;
+      }
+
+      std::uint32_t seq;
+      if(!rsss.crcValid()) {
+        ++result.rejected;
+      }
+      else if(!intact(frame, got, seq)) {
+        ++result.undetected;
+      }
+      else {
+        auto arrival = Clock::now();
+        if(seq > expected) {
+          auto dark = std::chrono::duration<double>(arrival - lastGood).count() - period;
+          result.missing += seq - expected;
+          result.resync  += dark;
+          result.worst    = std::max(result.worst, dark);
+          ++result.gaps;
+        }
+
+        ++result.good;
+        expected = seq + 1;
+        lastGood = arrival;
+      }
+
+      got = 0;
+    }
+  }
+
+  result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // keep draining so a writer blocked on a full link can notice the stop
+  stop = true;
+  while(!done) {
+    std::uint8_t discard[4096];
+    pollfd wait{ fd, POLLIN, 0 };
+    if(poll(&wait, 1, 10) > 0) {
+      ::read(fd, discard, sizeof(discard));
+    }
+  }
+
+  writer.join();
+  return result;
+}
+
+
+struct Urgency {
+  std::uint64_t sent;    // urgent frames
+  std::uint64_t got;
+  std::uint64_t bytes;   // payload bytes delivered, bulk and urgent
+  double        latency; // summed over all urgent frames, in seconds
+  double        worst;
+  double        seconds;
+};
+
+
+// keep a deep send queue full of bulk frames and send an urgent one every
+// URGENT_GAP milliseconds, straight through RSSS::write() or held back by a
+// Pacer, and time how long the urgent ones take to arrive
+static Urgency runUrgent(Tail tail, bool paced) {
+  // the deep queue is the link's own, like a driver's it can't be asked
+  // how full it is, so the pacer goes by its line rate estimate
+  LinkModel model;
+  model.baud = PACED_BAUD;
+  model.fifo = DEEP_QUEUE;
+
+  LinkSim link(model);
+  Urgency result{};
+  std::atomic<bool> stop{ false }, done{ false };
+  const auto start = Clock::now();
+
+  std::thread writer([&]() {
+    const int fd = link.end(0);
+    if(paced) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    RSSS rsss(fd, tail);
+    Pacer pacer(rsss, PACED_BAUD, PACE_DELAY);
+    std::uint8_t bulk[FRAME], urgent[URGENT] = {};
+    auto next = start;
+
+    fill(bulk, 0);
+    while(!stop) {
+      if(Clock::now() >= next) {
+        auto stamp = std::chrono::duration<double>(Clock::now() - start).count();
+        memcpy(urgent, &stamp, sizeof(stamp));
+        next += std::chrono::milliseconds(URGENT_GAP);
+        ++result.sent;
+
+        if(paced) {
+          pacer.queue(urgent, URGENT, true);
+        }
+        else if(rsss.write(urgent, URGENT) != URGENT) {
+          break;
+        }
+      }
+
+      if(!paced) {
+        // bulk only while the queue has room, so urgent frames keep their schedule
+        pollfd room{ fd, POLLOUT, 0 };
+        if(poll(&room, 1, 1) > 0 && rsss.write(bulk, FRAME) != FRAME) {
+          break;
+        }
+        continue;
+      }
+
+      while(pacer.held() < 4) {
+        pacer.queue(bulk, FRAME);
+      }
+
+      if(pacer.pump() < 0) {
+        break;
+      }
+
+      // sleep until the next frame fits or the next urgent one is due
+      auto due  = std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count();
+      auto wait = pacer.wait();
+      std::this_thread::sleep_for(std::chrono::milliseconds(std::max<long long>(1, std::min<long long>(wait < 0 ? URGENT_GAP : wait, due))));
+    }
+
+    done = true;
+  });
+
+  const int fd = link.end(1);
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  RSSS rsss(fd, tail);
+  std::uint8_t frame[FRAME];
+  int got = 0;
+
+  for(auto now = start; now - start < std::chrono::duration<double>(DURATION); now = Clock::now()) {
+    pollfd wait{ fd, POLLIN, 0 };
+    poll(&wait, 1, 10);
+
+    for(int count; (count = rsss.read(&frame[got], static_cast<std::uint16_t>(FRAME - got))) > 0; ) {
+      if((got += count) < FRAME && rsss.remaining()) {
+        continue;
+      }
+
+      if(rsss.crcValid()) {
+        result.bytes += got;
+
+        if(got == URGENT) {
+          double stamp;
+          memcpy(&stamp, frame, sizeof(stamp));
+
+          auto latency = std::chrono::duration<double>(Clock::now() - start).count() - stamp;
+          result.latency += latency;
+          result.worst    = std::max(result.worst, latency);
+          ++result.got;
+        }
+      }
+
+      got = 0;
+    }
+  }
+
+  result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // keep draining so a writer blocked on a full link can notice the stop
+  stop = true;
+  while(!done) {
+    std::uint8_t discard[4096];
+    pollfd wait{ fd, POLLIN, 0 };
+    if(poll(&wait, 1, 10) > 0) {
+      ::read(fd, discard, sizeof(discard));
+    }
+  }
+
+  writer.join();
+  return result;
+}
+
+
+int main(int argc, char **argv) {
+  struct Link {
+    const char *name;
+    LinkModel   model;
+  };
+
+  std::vector<Link> links;
+  auto add = [&](const char *name, auto &&adjust) {
+    LinkModel model;
+    model.baud = BAUD;
+    adjust(model);
+    links.push_back({ name, model });
+  };
+
+  add("clean",      [](LinkModel &)   {});
+  add("ber 1e-6",   [](LinkModel &m)  { m.bitError = 1e-6; });
+  add("ber 1e-5",   [](LinkModel &m)  { m.bitError = 1e-5; });
+  add("ber 1e-4",   [](LinkModel &m)  { m.bitError = 1e-4; });
+  add("ber 1e-3",   [](LinkModel &m)  { m.bitError = 1e-3; });
+  add("burst 1e-4", [](LinkModel &m)  { m.burstEnter = 1e-4; });
+  add("drop 1e-4",  [](LinkModel &m)  { m.drop = 1e-4; });
+  add("jitter",     [](LinkModel &m)  { m.latency = 0.002; m.jitter = 0.001; m.bitError = 1e-5; });
+
+  static const struct { const char *name; bool cobs; } FRAMERS[] = {
+    { "",      false },
+    { " cobs", true  },
+  };
+
+  static const struct { const char *name; Tail tail; } TAILS[] = {
+    { "",        Tail::None   },
+    { " crc16",  Tail::Crc16  },
+    { " crc32c", Tail::Crc32c },
+  };
+
+  printf("%u baud, %d byte frames, %.0f s per link\n", BAUD, FRAME, DURATION);
+  printf("%-24s %8s %8s %8s %8s %8s %10s %8s %10s %10s\n", "link", "sent", "good", "rejected",
+         "undetect", "missing", "goodput", "of line", "resync ms", "worst ms");
+
+  for(auto &link: links) {
+    for(auto &framer: FRAMERS) {
+      for(auto &tail: TAILS) {
+        auto name = std::string(link.name) + framer.name + tail.name;
+        if(!selected(name.c_str(), argc, argv)) {
+          continue;
+        }
+
+        auto r = framer.cobs ? run<Cobs>(link.model, tail.tail) : run<RSSS>(link.model, tail.tail);
+        auto goodput = r.good * FRAME / r.seconds;
+
+        printf("%-24s %8llu %8llu %8llu %8llu %8llu %8.1f K %7.1f%% %10.2f %10.2f\n", name.c_str(),
+               static_cast<unsigned long long>(r.sent),     static_cast<unsigned long long>(r.good),
+               static_cast<unsigned long long>(r.rejected), static_cast<unsigned long long>(r.undetected),
+               static_cast<unsigned long long>(r.missing),  goodput / 1e3, goodput * 1000.0 / BAUD,
+               r.gaps ? r.resync * 1e3 / r.gaps : 0.0, r.worst * 1e3);
+      }
+    }
+  }
+
+  printf("\n%u baud, %d byte bulk frames, a %d byte urgent frame every %d ms, %d ms pacer delay\n",
+         PACED_BAUD, FRAME, URGENT, URGENT_GAP, PACE_DELAY);
+  printf("%-24s %8s %8s %10s %8s %10s %10s\n", "urgent", "sent", "arrived", "goodput", "of line", "avg ms", "worst ms");
+
+  for(bool paced: { false, true }) {
+    for(auto &tail: TAILS) {
+      auto name = std::string(paced ? "urgent paced" : "urgent direct") + tail.name;
+      if(!selected(name.c_str(), argc, argv)) {
+        continue;
+      }
+
+      auto r = runUrgent(tail.tail, paced);
+      auto goodput = r.bytes / r.seconds;
+
+      printf("%-24s %8llu %8llu %8.1f K %7.1f%% %10.1f %10.1f\n", name.c_str(),
+             static_cast<unsigned long long>(r.sent), static_cast<unsigned long long>(r.got),
+             goodput / 1e3, goodput * 1000.0 / PACED_BAUD,
+             r.got ? r.latency * 1e3 / r.got : 0.0, r.worst * 1e3);
+    }
+  }
+
+  return 0;
+}
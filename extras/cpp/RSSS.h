@@ -2,36 +2,178 @@
 #  define RSSS_H
 
 #include <array>
+#include <chrono>
+#include <vector>
 #include <cstdint>
+#include <sys/types.h>
+
+struct iovec;
 
 
 namespace rsss {
 
+// Optional integrity check appended to each synchronized region. CRC32C
+// regions are marked in their sync header, and a reader set to CRC32C takes
+// both marked and unmarked regions. Readers with any other setting ignore
+// marked headers, so both ends of a CRC32C link have to be set to it.
+enum class Tail : std::uint8_t {
+  None,
+  Crc16,
+  Crc32c
+};
+
+
+// Read-only view of bytes owned by someone else.
+struct Span {
+  const std::uint8_t *data;
+  std::size_t         size;
+
+  const std::uint8_t *begin() const { return data; }
+  const std::uint8_t *end()   const { return data + size; }
+  bool                empty() const { return !size; }
+};
+
+
+// A whole synchronized region as it sits in the read buffer.
+struct FrameView {
+  Span header;
+  Span payload;
+  Span tail;    // empty for regions without one
+  bool valid;   // the tail CRC matched, always true without a tail
+};
+
+
+// Reads go through an internal read-ahead buffer filled by large reads, so
+// bytes past the current region may already have been taken from the
+// descriptor. Use one RSSS per descriptor and don't read from it directly.
+// The buffer also holds on to the region being read, so when its tail CRC
+// fails the bytes after its sync byte are scanned again for the real headers
+// the bogus region swallowed, and read() starts returning those.
+// Writes gather header, payload and tail into a single writev. When a short
+// write cuts a header or tail, the rest is sent by the next write(), tick()
+// or flush(), whichever comes first. A cut payload simply counts fewer bytes
+// written.
 class RSSS {
   public:
-    RSSS(int s, bool t = false);
+    RSSS(int s, bool t = false): RSSS(s, t ? Tail::Crc16 : Tail::None) {}
+    RSSS(int s, Tail t);
     RSSS(): RSSS(-1) {}
 
     int  read(       std::uint8_t *, std::uint16_t); // find a synchronization point and then read bytes
     int  write(const std::uint8_t *, std::uint16_t); // emit a synchronization point and then write bytes
     bool crcValid() const { return valid; }
+    Tail tailType() const { return tail; } // the tail written after each region
+
+    // frame each span as a region of its own and send them with as few
+    // writev calls as the descriptor allows, looping only on short writes.
+    // Returns how many whole frames were committed, from the front, or -1 on
+    // errors before the first one. A frame cut by a short write is committed
+    // too, its rest is copied and sent ahead of the next write. Empty spans
+    // are skipped like write() does and count as committed. Fails with EBUSY
+    // while write() is inside a region, and stops at spans longer than a
+    // region can be with errno set to EMSGSIZE, returning -1 when that is the
+    // first one
+    int  writeFrames(const Span *, std::size_t);
+    int  writeFrames(const std::vector<Span> &frames) { return writeFrames(frames.data(), frames.size()); }
+
+    // give up on a region once no byte arrived for this many milliseconds,
+    // 0 (the default) waits forever; the bytes after its sync byte are then
+    // scanned again and truncated() turns true until the next header
+    void setFrameTimeout(int ms) { timeout = ms; }
+    bool truncated() const { return stalled; }
+
+    // point frame at the next whole region in the read buffer without copying
+    // it, the view stays valid until release(), which must come before the
+    // next read() or readFrame(); returns 1 for a frame, 0 when none is
+    // complete yet and -1 on errors
+    int  readFrame(FrameView &frame);
+    void release();
+
+    int  remaining() const { return readSync + (remain != 0); } // bytes of the current region not yet returned by read()
+
+    // headers announcing more than this many bytes are taken for line noise
+    void setMaxLength(std::uint16_t length) { maxLength = length; }
+
+    // only accept a header once another header shows up right behind its
+    // region, or its tail CRC matches, and otherwise back off and scan again
+    // from the byte after it. Regions are delivered once the next header or
+    // their own tail has arrived, so without a tail the last one waits for
+    // the next write, and one followed by stray bytes is dropped
+    void setConfirm(bool on) { confirm = on; }
+
+    // send an empty sync point whenever nothing was written for this many
+    // milliseconds, so receivers that attach or lose sync while the link is
+    // quiet find it again; 0 (the default) turns it off. Heartbeats only go
+    // out from tick(), which returns 1 when it sent one, or in stream mode
+    // sent the staged bytes because their time was up, 0 when nothing was
+    // due and -1 on errors. tick() also sends what a short write left of a
+    // header or tail, heartbeat or not
+    void setHeartbeat(int ms) { heartbeat = ms; }
+    int  tick();
+
+    // stream mode: instead of a region per write(), written bytes are staged
+    // and sent as one region once that many have gathered, or once the oldest
+    // has waited ms milliseconds, so the overhead no longer depends on how
+    // the caller slices its writes. With ms = 0 only the byte count and
+    // flush() send them, otherwise write() and tick() check the time too.
+    // bytes = 0 (the default) turns it off. Anything staged is sent first;
+    // returns 1 once the mode changed, 0 when the descriptor couldn't take
+    // the staged bytes yet and -1 on errors, EBUSY while write() is inside a
+    // region. Nothing changes unless it returns 1
+    int  setCadence(std::uint16_t bytes, int ms = 0);
+
+    // send staged bytes, and the rest of a header or tail a short write
+    // cut, now; returns 1 once nothing is left, 0 when the descriptor can't
+    // take more yet and -1 on errors
+    int  flush();
 
     explicit operator int() const { return serial; }
 
   private:
     int                         serial;
+    std::vector<std::uint8_t>   buffer;
+    std::size_t                 head;
+    std::size_t                 fill;
+    std::size_t                 viewed;
+    std::size_t                 lookback; // offset of the current region's header in buffer
     std::array<std::uint8_t, 4> last;
-    std::uint16_t               readCrc;
+    std::uint32_t               readCrc;
     std::uint16_t               readSync;
-    std::uint16_t               writeCrc;
+    std::uint32_t               writeCrc;
     std::uint16_t               writeSync;
+    std::vector<std::uint8_t>   owed;     // header and tail bytes a short write left behind
+    std::size_t                 owedAt;
+    std::vector<std::uint8_t>   stage;    // stream mode bytes waiting for their region
+    std::size_t                 staged;
+    int                         cadence;
+    std::chrono::steady_clock::time_point stagedAt;
+    std::uint16_t               maxLength;
     std::int8_t                 remain;
     std::uint8_t                hold;
-    bool                        addTail;
+    Tail                        tail;
+    Tail                        readTail;
     bool                        valid;
+    bool                        confirm;
+    bool                        stalled;
+    int                         timeout;
+    int                         heartbeat;
+    std::chrono::steady_clock::time_point lastByte;
+    std::chrono::steady_clock::time_point lastWrite;
 
+    int           confirmed(std::uint16_t, Tail, std::uint32_t) const;
+    int           await() const;
+    void          abandon();
+    ssize_t       refill(std::size_t = 0, bool = false);
     std::uint16_t findSync();
-    bool          emitSync(std::uint16_t);
+    int           gather(iovec *);
+    std::size_t   settle(std::size_t);
+    void          owe(const std::uint8_t *, std::size_t);
+    void          oweFrame(const std::uint8_t *, Span, std::size_t);
+    int           stream(const std::uint8_t *, std::uint16_t);
+    int           emitStage();
+
+    std::array<std::uint8_t, 4>        syncHeader(std::uint16_t) const;
+    static std::array<std::uint8_t, 4> tailBytes(std::uint32_t);
 };
 
 }
@@ -1,43 +1,130 @@
 #include "RSSS.h"
 #include "RsssCrc8.h"
 #include "RsssCrc16.h"
+#include "RsssCrc32c.h"
+#include "RsssSync.h"
 
 #include <errno.h>
 #include <cstring>
+#include <algorithm>
+#include <poll.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/uio.h>
 
-#define CRC8_SEED    0x78
-#define CRC16_SEED 0x8795
+#define CRC8_SEED          0x78
+#define CRC8_SEED_CRC32C   0x87 // marks regions followed by a CRC32C tail
+#define CRC16_SEED       0x8795
+#define CRC32C_SEED      0x0000
+#define READ_AHEAD      0x20000 // room for a whole region with its header and tail
+#define WRITE_BATCH         256 // frames gathered into one writev, well below IOV_MAX
 
 
 using namespace rsss;
 
 
-RSSS::RSSS(int s, bool t):
+static int tailSize(Tail tail) {
+  switch(tail) {
+    case Tail::Crc16:  return 2;
+    case Tail::Crc32c: return 4;
+    default:           return 0;
+  }
+}
+
+
+static bool tailMatches(Tail tail, std::uint32_t crc, const std::uint8_t *bytes) {
+  switch(tail) {
+    case Tail::Crc16:  return !calcCrc16(bytes, 2, static_cast<std::uint16_t>(crc));
+    case Tail::Crc32c: return crc == (bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24));
+    default:           return true;
+  }
+}
+
+
+// the CRC32C seed is only taken by readers set to CRC32C, everywhere else it
+// would just double the chance of line noise passing for a header
+static std::uint8_t markedSeed(Tail tail) {
+  return tail == Tail::Crc32c ? CRC8_SEED_CRC32C : CRC8_SEED;
+}
+
+
+static bool isHeader(const std::uint8_t *header, Tail tail) {
+  return header[0] == 0xAA && (validateCrc8(header, 4, CRC8_SEED) || validateCrc8(header, 4, markedSeed(tail)));
+}
+
+
+static std::uint32_t updateCrc(Tail tail, std::uint32_t crc, const std::uint8_t *data, int count) {
+  switch(tail) {
+    case Tail::Crc16:  return calcCrc16(data, count, static_cast<std::uint16_t>(crc));
+    case Tail::Crc32c: return calcCrc32c(data, count, crc);
+    default:           return crc;
+  }
+}
+
+
+RSSS::RSSS(int s, Tail t):
   serial(s),
+  buffer(),
+  head(0),
+  fill(0),
+  viewed(0),
+  lookback(0),
   last{ 0, 0, 0, 0 },
   readCrc(0),
   readSync(0),
   writeCrc(0),
   writeSync(0),
+  owed(),
+  owedAt(0),
+  stage(),
+  staged(0),
+  cadence(0),
+  stagedAt(),
+  maxLength(0xFFFF),
   remain(0),
   hold(0),
-  addTail(t),
-  valid(!t) {}
+  tail(t),
+  readTail(t),
+  valid(t == Tail::None),
+  confirm(false),
+  stalled(false),
+  timeout(0),
+  heartbeat(0),
+  lastByte(),
+  lastWrite() {}
 
 
 int RSSS::read(std::uint8_t *data, std::uint16_t length) {
-  if(addTail && remain != 0) {
-    auto count = ::read(serial, &last[2 - remain], remain);
-    if(count > 0) {
-      if(!(remain -= count)) {
-        valid = !calcCrc16(&last[0], 2, readCrc);
-        *data = hold;
-        return 1;
+  if(viewed) {
+    errno = EBUSY; // a frame view still owns the front of the buffer
+    return -1;
+  }
+
+  if(readTail != Tail::None && remain != 0) {
+    if(head == fill && refill() < 0) {
+      if(errno == ETIMEDOUT) {
+        abandon();
+        return 0;
+      }
+      else if(errno != EAGAIN) {
+        return -1; // blocking isn't an error, but everything else is
       }
     }
-    else if(count < 0 && errno != EAGAIN) {
-      return count; // blocking isn't an error, but everything else is
+
+    auto size  = tailSize(readTail);
+    auto count = std::min<std::size_t>(remain, fill - head);
+    memcpy(&last[size - remain], &buffer[head], count);
+    head += count;
+
+    if(count > 0 && !(remain -= count)) {
+      valid = tailMatches(readTail, readCrc, &last[0]);
+
+      if(!valid) {
+        head = lookback + 1; // the region was bogus, look for the headers it swallowed
+      }
+
+      *data = hold;
+      return 1;
     }
 
     return 0;  // didn't read enough to validate
@@ -48,23 +135,27 @@ int RSSS::read(std::uint8_t *data, std::uint16_t length) {
   }
 
   if(readSync > 0) {
-    auto count = ::read(serial, data, std::min(length, readSync));
-
-    if(count > 0) {
-      if(addTail) {
-        readCrc = calcCrc16(data, count, readCrc);
+    if(head == fill) {
+      if(auto got = refill(); got < 0 && errno == ETIMEDOUT) {
+        abandon();
+        return 0;
       }
-
-      readSync -= count;
-
-      if(!readSync && addTail) {
-        remain = 2;
-        hold = data[count -= 1];
-        return count + read(&data[count], 1);
+      else if(got <= 0) {
+        return got < 0 && errno != EAGAIN ? -1 : 0; // blocking isn't an error
       }
     }
-    else if(count < 0 && errno == EAGAIN) {
-      count = 0; // blocking isn't an error
+
+    int count = static_cast<int>(std::min<std::size_t>({ length, readSync, fill - head }));
+    memcpy(data, &buffer[head], count);
+    head += count;
+
+    readCrc = updateCrc(readTail, readCrc, data, count);
+    readSync -= count;
+
+    if(!readSync && readTail != Tail::None) {
+      remain = tailSize(readTail);
+      hold = data[count -= 1];
+      return count + read(&data[count], 1);
     }
 
     return count;
@@ -74,107 +165,588 @@ int RSSS::read(std::uint8_t *data, std::uint16_t length) {
 }
 
 
-int RSSS::write(const std::uint8_t *data, std::uint16_t length) {
-  int retVal = 0;
-  auto count = length;
+int RSSS::readFrame(FrameView &frame) {
+  if(viewed || readSync || remain) {
+    errno = EBUSY; // release the last view, or finish the region read() is in, first
+    return -1;
+  }
+
+  while(true) {
+    head += scanSync(buffer.data() + head, fill - head, CRC8_SEED, markedSeed(tail));
+
+    std::size_t size    = 0;
+    bool        partial = false; // the region itself is still missing bytes
+    if(fill - head >= 4) {
+      auto header = &buffer[head];
+      auto length = static_cast<std::size_t>(header[1] | (header[2] << 8));
+
+      if(!length) {
+        head += 4;
+        continue; // empty regions carry nothing to view
+      }
+
+      if(length > maxLength) {
+        head += 1;
+        continue; // too long to be real
+      }
+
+      // unmarked regions carry a CRC16 tail only when both ends agree on it
+      auto plain = validateCrc8(header, 4, CRC8_SEED);
+      auto kind  = !plain ? Tail::Crc32c : tail == Tail::Crc16 ? Tail::Crc16 : Tail::None;
+      size    = 4 + length + tailSize(kind);
+      partial = fill - head < size;
+
+      if(confirm) {
+        if(auto check = confirmed(static_cast<std::uint16_t>(length), kind, !plain ? CRC32C_SEED : CRC16_SEED); !check) {
+          head += 1;
+          continue; // nothing vouches for it, back off and look again
+        }
+        else if(check < 0) {
+          size += 4; // wait for the next header
+        }
+      }
+
+      if(fill - head >= size) {
+        auto crc = updateCrc(kind, !plain ? CRC32C_SEED : CRC16_SEED, header + 4, static_cast<int>(length));
+
+        frame.header  = { header, 4 };
+        frame.payload = { header + 4, length };
+        frame.tail    = { header + 4 + length, static_cast<std::size_t>(tailSize(kind)) };
+        frame.valid   = tailMatches(kind, crc, frame.tail.data);
+        viewed        = frame.valid ? size : 1; // failed regions get rescanned past their sync byte
+        stalled       = false;
+        return 1;
+      }
+    }
+
+    // make room for the whole region behind its header before reading more
+    if(auto got = refill(size, partial); got < 0 && errno == ETIMEDOUT) {
+      head   += 1;
+      stalled = true; // the sender went quiet mid region, look past its sync byte
+    }
+    else if(got <= 0) {
+      return got < 0 && errno != EAGAIN ? -1 : 0; // blocking isn't an error
+    }
+  }
+}
+
 
+void RSSS::release() {
+  head  += viewed;
+  viewed = 0;
+}
+
+
+// owed framing bytes go out first, then a header when no region is open,
+// the payload and, once it completes the region, the tail, all gathered into
+// one writev. Whatever part of a header or tail a short write leaves behind
+// is owed and goes first next time, payload bytes are simply not counted
+int RSSS::write(const std::uint8_t *data, std::uint16_t length) {
   if(length == 0) {
-    goto complete;
+    return 0;
+  }
+  else if(!stage.empty()) {
+    return stream(data, length);
+  }
+
+  const bool open   = !writeSync;
+  const auto region = open ? length : writeSync;
+  const auto count  = std::min(length, region);
+  const auto size   = tailSize(tail);
+  const auto seed   = open ? (tail == Tail::Crc32c ? CRC32C_SEED : CRC16_SEED) : writeCrc;
+  const auto crc    = updateCrc(tail, seed, data, count);
+
+  std::array<std::uint8_t, 4> header = syncHeader(length), bytes = tailBytes(crc);
+  std::array<iovec, 4> iov;
+  int parts = gather(&iov[0]);
+
+  if(open) {
+    iov[parts++] = { header.data(), header.size() };
+  }
+
+  iov[parts++] = { const_cast<std::uint8_t *>(data), count };
+
+  if(count == region && size) {
+    iov[parts++] = { bytes.data(), static_cast<std::size_t>(size) };
+  }
+
+  auto sent = ::writev(serial, iov.data(), parts);
+  if(sent < 0) {
+    return errno == EAGAIN ? 0 : -1; // blocking isn't an error
+  }
+
+  auto left = settle(sent);
+  if(!owed.empty() || (open && !left)) {
+    return 0; // the owed bytes took it all, nothing of this region went out
+  }
+
+  if(open) {
+    auto took = std::min<std::size_t>(left, 4);
+    writeSync = length;
+    writeCrc  = seed;
+    left     -= took;
+
+    if(took < 4) {
+      owe(&header[took], 4 - took);
+      return 0;
+    }
+  }
+
+  auto took = std::min<std::size_t>(left, count);
+  writeSync -= took;
+  writeCrc   = took == count ? crc : updateCrc(tail, writeCrc, data, static_cast<int>(took));
+  left      -= took;
+
+  if(!writeSync && size) {
+    owe(&bytes[left], size - left); // the syncronized chunk was completed
+  }
+
+  return static_cast<int>(took);
+}
+
+
+int RSSS::writeFrames(const Span *frames, std::size_t count) {
+  if(writeSync) {
+    errno = EBUSY; // finish the region write() is in first
+    return -1;
   }
 
-  if(writeSync > 0) {
-    if(auto sent = ::write(serial, data, std::min(count, writeSync)); sent > 0) {
-      if(addTail) { writeCrc = calcCrc16(data, sent, writeCrc); }
+  if(auto done = emitStage(); done <= 0) {
+    return done; // streamed bytes go first
+  }
+
+  const auto size = static_cast<std::size_t>(tailSize(tail));
+  const auto seed = tail == Tail::Crc32c ? CRC32C_SEED : CRC16_SEED;
 
-      writeSync -= sent;
-      count -= sent;
-      data += sent;
-      retVal = sent;
+  std::array<iovec, 1 + 3 * WRITE_BATCH>                      iov;
+  std::array<std::array<std::uint8_t, 8>, WRITE_BATCH> framing; // header then tail of each frame
+  std::size_t committed = 0;
+
+  while(true) {
+    // empty frames cost nothing, they are committed as soon as they are next
+    while(committed < count && !frames[committed].size) {
+      ++committed;
+    }
 
-      if(writeSync != 0) {
-        goto complete;
+    int parts = gather(&iov[0]);
+    std::size_t batch = 0;
+
+    for(; committed + batch < count && batch < WRITE_BATCH; ++batch) {
+      auto &frame = frames[committed + batch];
+      auto &bytes = framing[batch];
+
+      if(frame.size > 0xFFFF) {
+        break;
+      }
+      else if(!frame.size) {
+        continue; // nothing to frame, like write()
       }
-      else if(addTail) {
-        // the syncronized chunk was completed
-        std::uint8_t buffer[2] = { static_cast<std::uint8_t>( writeCrc       & 0xFF),
-                                   static_cast<std::uint8_t>((writeCrc >> 8) & 0xFF) };
-        ::write(serial, buffer, 2);
+
+      auto header = syncHeader(static_cast<std::uint16_t>(frame.size));
+      auto check  = tailBytes(updateCrc(tail, seed, frame.data, static_cast<int>(frame.size)));
+      memcpy(&bytes[0], header.data(), 4);
+      memcpy(&bytes[4], check.data(), 4);
+
+      iov[parts++] = { &bytes[0], 4 };
+      iov[parts++] = { const_cast<std::uint8_t *>(frame.data), frame.size };
+      if(size) {
+        iov[parts++] = { &bytes[4], size };
       }
     }
-    else if(sent < 0 && errno != EAGAIN) {
-      goto failure;
+
+    if(!parts) {
+      break; // everything is out, or the next span can't be framed
     }
-  }
 
-  if(count > 0) {
-    // emit a synchronization point
-    if(emitSync(length)) {
-      writeSync = length;
+    auto sent = ::writev(serial, iov.data(), parts);
+    if(sent < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      else if(errno == EAGAIN) {
+        break;
+      }
+
+      return committed ? static_cast<int>(committed) : -1;
     }
-    else if(retVal || errno == EAGAIN) {
-      goto complete;
+
+    auto left = settle(sent);
+    if(!owed.empty()) {
+      continue; // still paying off an earlier cut
     }
-    else {
-      goto failure;
+
+    for(std::size_t i = 0; i < batch && left; ++i, ++committed) {
+      auto &frame = frames[committed];
+      auto &bytes = framing[i];
+      auto  total = frame.size ? 4 + frame.size + size : 0;
+
+      if(left >= total) {
+        left -= total;
+        continue;
+      }
+
+      oweFrame(&bytes[0], frame, left); // the write cut it
+      left = 0;
     }
+  }
+
+  if(committed < count && frames[committed].size > 0xFFFF) {
+    errno = EMSGSIZE;
+    return committed ? static_cast<int>(committed) : -1;
+  }
 
-    if(auto sent = ::write(serial, data, count); sent > 0) {
-      writeSync -= sent;
-      retVal += sent;
+  return static_cast<int>(committed);
+}
 
-      if(addTail) {
-        writeCrc = calcCrc16(data, sent, writeCrc);
 
-        if(!writeSync) {
-          // the syncronized chunk was completed
-          std::uint8_t buffer[2] = { static_cast<std::uint8_t>( writeCrc       & 0xFF),
-                                     static_cast<std::uint8_t>((writeCrc >> 8) & 0xFF) };
-          ::write(serial, buffer, 2);
-        }
+// stage bytes until a whole region of them is there, or the oldest has
+// waited for the cadence, and send them as one region, however the caller
+// slices them
+int RSSS::stream(const std::uint8_t *data, std::uint16_t length) {
+  if(staged && cadence > 0 && std::chrono::steady_clock::now() - stagedAt >= std::chrono::milliseconds(cadence)) {
+    if(emitStage() < 0) {
+      return -1;
+    }
+  }
+
+  std::size_t taken = 0;
+  while(taken < length) {
+    if(staged == stage.size()) {
+      if(auto done = emitStage(); done <= 0) {
+        return taken ? static_cast<int>(taken) : done;
       }
     }
-    else if(sent < 0 && errno != EAGAIN && !retVal) {
-      goto failure; // something bad happened
+
+    if(!staged) {
+      stagedAt = std::chrono::steady_clock::now();
+    }
+
+    auto count = std::min<std::size_t>(length - taken, stage.size() - staged);
+    memcpy(&stage[staged], data + taken, count);
+    staged += count;
+    taken  += count;
+  }
+
+  if(staged == stage.size()) {
+    emitStage(); // whatever doesn't go out now goes with the next call
+  }
+
+  return static_cast<int>(taken);
+}
+
+
+int RSSS::setCadence(std::uint16_t bytes, int ms) {
+  if(writeSync) {
+    errno = EBUSY; // finish the region write() is in first
+    return -1;
+  }
+
+  if(auto done = emitStage(); done <= 0) {
+    return done; // the staged bytes are kept for the next try
+  }
+
+  stage.assign(bytes, 0);
+  staged  = 0;
+  cadence = ms;
+  return 1;
+}
+
+
+int RSSS::flush() {
+  if(auto done = emitStage(); done <= 0) {
+    return done;
+  }
+
+  while(!owed.empty()) {
+    iovec iov;
+    gather(&iov);
+
+    auto sent = ::writev(serial, &iov, 1);
+    if(sent < 0) {
+      return errno == EAGAIN ? 0 : -1;
     }
+
+    settle(sent);
+  }
+
+  return 1;
+}
+
+
+int RSSS::tick() {
+  if(staged && cadence > 0 && std::chrono::steady_clock::now() - stagedAt >= std::chrono::milliseconds(cadence)) {
+    return emitStage();
   }
 
-complete:
-  return retVal;
+  // not due, or inside a region where a header would be taken for payload
+  const bool due = !staged && heartbeat > 0 && writeSync == 0 &&
+                   std::chrono::steady_clock::now() - lastWrite >= std::chrono::milliseconds(heartbeat);
+
+  if(!due && owed.empty()) {
+    return 0;
+  }
+
+  std::array<std::uint8_t, 4> header = syncHeader(0);
+  std::array<iovec, 2> iov;
+  int parts = gather(&iov[0]);
+
+  if(due) {
+    iov[parts++] = { header.data(), header.size() };
+  }
+
+  auto sent = ::writev(serial, iov.data(), parts);
+  if(sent < 0) {
+    return errno == EAGAIN ? 0 : -1;
+  }
+
+  if(auto left = settle(sent); due && owed.empty() && left) {
+    owe(&header[left], 4 - left);
+    return 1;
+  }
+
+  return 0;
+}
+
+
+// move unread bytes to the front when the end is reached, or when fewer than
+// want bytes fit behind head, and read as much as fits. Inside a region the
+// bytes from its header on are kept as well, so a failed tail can rescan them,
+// and the frame timeout applies while waiting for more
+ssize_t RSSS::refill(std::size_t want, bool pending) {
+  if(buffer.empty()) {
+    buffer.resize(READ_AHEAD);
+  }
+
+  const std::size_t keep = readSync || remain ? lookback : head;
+
+  if(keep == fill) {
+    head = fill = 0;
+  }
+  else if(fill == buffer.size() || buffer.size() - keep < want) {
+    memmove(&buffer[0], &buffer[keep], fill - keep);
+    fill     -= keep;
+    head     -= keep;
+    lookback -= keep;
+  }
+
+  if(timeout > 0 && (pending || readSync || remain)) {
+    if(auto ready = await(); ready < 0) {
+      return ready;
+    }
+  }
+
+  auto got = ::read(serial, &buffer[fill], buffer.size() - fill);
+  if(got > 0) {
+    fill    += got;
+    lastByte = std::chrono::steady_clock::now();
+  }
+
+  return got;
+}
+
+
+// wait for input until the frame timeout runs out, counting from the last
+// byte received; fails with ETIMEDOUT once it has, or with EAGAIN when a
+// non-blocking descriptor has nothing yet
+int RSSS::await() const {
+  using namespace std::chrono;
+
+  const auto left     = timeout - duration_cast<milliseconds>(steady_clock::now() - lastByte).count();
+  const bool blocking = !(fcntl(serial, F_GETFL) & O_NONBLOCK);
+
+  pollfd wait{ serial, POLLIN, 0 };
+  auto ready = poll(&wait, 1, blocking && left > 0 ? static_cast<int>(left) : 0);
+
+  if(ready == 0) {
+    errno = blocking || left <= 0 ? ETIMEDOUT : EAGAIN;
+    return -1;
+  }
 
-failure:
-  retVal = -1;
-  goto complete;
+  return ready;
+}
+
+
+// drop the region the sender stopped in, its header may well have been a
+// false one that swallowed real headers, so those get scanned again
+void RSSS::abandon() {
+  readSync = 0;
+  remain   = 0;
+  valid    = false;
+  stalled  = true;
+  head     = lookback + 1;
 }
 
 
 std::uint16_t RSSS::findSync() {
+  std::size_t want;
+
   do {
-    if(last[0] == 0xAA && validateCrc8(&last[0], 4, CRC8_SEED)) {
-      auto retVal = last[1] | (last[2] << 8);
-      memset(&last[0], 0, 4);
-      readCrc = CRC16_SEED;
-      valid = !addTail;
-      return retVal;
-    }
+    want  = 0;
+    head += scanSync(buffer.data() + head, fill - head, CRC8_SEED, markedSeed(tail));
+
+    while(fill - head >= 4) {
+      auto header = &buffer[head];
+      auto length = static_cast<std::uint16_t>(header[1] | (header[2] << 8));
+      auto plain  = validateCrc8(header, 4, CRC8_SEED);
+
+      // unmarked regions carry a CRC16 tail only when both ends agree on it
+      auto kind  = !plain ? Tail::Crc32c : tail == Tail::Crc16 ? Tail::Crc16 : Tail::None;
+      auto seed  = !plain ? CRC32C_SEED  : CRC16_SEED;
+      auto check = length > maxLength ? 0 : confirm && length ? confirmed(length, kind, seed) : 1;
+
+      if(check < 0) {
+        want = 8 + length + tailSize(kind);
+        break; // wait for whatever comes after the region
+      }
+
+      if(!check) {
+        head += 1; // too long to be real, or nothing vouches for it
+        head += scanSync(buffer.data() + head, fill - head, CRC8_SEED, markedSeed(tail));
+        continue;
+      }
+
+      readTail = kind;
+      readCrc  = seed;
+      valid    = readTail == Tail::None || !length; // a heartbeat has no tail to check
+      stalled  = false;
+      lookback = head;
 
-    memmove(&last[0], &last[1], 3);
-  } while(::read(serial, &last[3], 1) == 1);
+      head += 4;
+      return length;
+    }
+  } while(refill(want) > 0);
 
   return 0;
 }
 
 
-bool RSSS::emitSync(std::uint16_t length) {
+// whether the region behind the header at head is vouched for by a header
+// right behind it or by its tail, or -1 when that can't be told yet
+int RSSS::confirmed(std::uint16_t length, Tail kind, std::uint32_t seed) const {
+  const std::size_t size = 4 + length + tailSize(kind);
+  const std::uint8_t *header = &buffer[head];
+
+  if(fill - head >= size + 4 && isHeader(header + size, tail)) {
+    return 1;
+  }
+
+  if(kind != Tail::None && fill - head >= size && tailMatches(kind, updateCrc(kind, seed, header + 4, length), header + 4 + length)) {
+    return 1;
+  }
+
+  return fill - head >= size + 4 ? 0 : -1;
+}
+
+
+// send the staged stream bytes as a region of their own, returns 1 once they
+// are committed, 0 when the descriptor took nothing of them yet and -1 on
+// errors
+int RSSS::emitStage() {
+  if(!staged) {
+    return 1;
+  }
+
+  const auto size = static_cast<std::size_t>(tailSize(tail));
+  const auto seed = tail == Tail::Crc32c ? CRC32C_SEED : CRC16_SEED;
+  const Span payload{ stage.data(), staged };
+
+  std::array<std::uint8_t, 8> framing;
+  auto header = syncHeader(static_cast<std::uint16_t>(staged));
+  auto check  = tailBytes(updateCrc(tail, seed, payload.data, static_cast<int>(staged)));
+  memcpy(&framing[0], header.data(), 4);
+  memcpy(&framing[4], check.data(), 4);
+
+  std::array<iovec, 4> iov;
+  int parts = gather(&iov[0]);
+
+  iov[parts++] = { &framing[0], 4 };
+  iov[parts++] = { stage.data(), staged };
+  if(size) {
+    iov[parts++] = { &framing[4], size };
+  }
+
+  auto sent = ::writev(serial, iov.data(), parts);
+  if(sent < 0) {
+    return errno == EAGAIN ? 0 : -1; // blocking isn't an error
+  }
+
+  auto left = settle(sent);
+  if(!owed.empty() || !left) {
+    return 0;
+  }
+
+  if(left < 4 + staged + size) {
+    oweFrame(&framing[0], payload, left);
+  }
+
+  staged = 0;
+  return 1;
+}
+
+
+// owe what a short write left of a frame from byte at on, framing holds its
+// header followed by its tail
+void RSSS::oweFrame(const std::uint8_t *framing, Span payload, std::size_t at) {
+  const auto size = static_cast<std::size_t>(tailSize(tail));
+
+  if(at < 4) {
+    owe(framing + at, 4 - at);
+    at = 4;
+  }
+
+  if(at < 4 + payload.size) {
+    owe(payload.data + at - 4, 4 + payload.size - at);
+    at = 4 + payload.size;
+  }
+
+  owe(framing + at - payload.size, 4 + payload.size + size - at);
+}
+
+
+std::array<std::uint8_t, 4> RSSS::syncHeader(std::uint16_t length) const {
   std::array<std::uint8_t, 4> packet{
     0xAA, static_cast<std::uint8_t>(length), static_cast<std::uint8_t>(length >> 8), 0
   };
-  appendCrc8(&packet[0], 3, 0x78);
+  appendCrc8(&packet[0], 3, tail == Tail::Crc32c ? CRC8_SEED_CRC32C : CRC8_SEED);
 
-  if(::write(serial, &packet[0], 4) == 4) {
-    writeCrc = CRC16_SEED;
-    return true;
+  return packet;
+}
+
+
+std::array<std::uint8_t, 4> RSSS::tailBytes(std::uint32_t crc) {
+  return { static_cast<std::uint8_t>( crc        & 0xFF),
+           static_cast<std::uint8_t>((crc >>  8) & 0xFF),
+           static_cast<std::uint8_t>((crc >> 16) & 0xFF),
+           static_cast<std::uint8_t>((crc >> 24) & 0xFF) };
+}
+
+
+// point iov at the framing bytes a short write left behind, if any
+int RSSS::gather(iovec *iov) {
+  if(owed.empty()) {
+    return 0;
+  }
+
+  *iov = { &owed[owedAt], owed.size() - owedAt };
+  return 1;
+}
+
+
+// count sent bytes against what was owed, returns the ones left over for
+// whatever came after it in the same writev
+std::size_t RSSS::settle(std::size_t sent) {
+  lastWrite = std::chrono::steady_clock::now();
+
+  auto took = std::min(sent, owed.size() - owedAt);
+  if((owedAt += took) == owed.size()) {
+    owed.clear();
+    owedAt = 0;
   }
 
-  return false;
+  return sent - took;
 }
 
+
+void RSSS::owe(const std::uint8_t *bytes, std::size_t size) {
+  owed.insert(owed.end(), bytes, bytes + size);
+}
@@ -0,0 +1,219 @@
+#include "RsssCapture.h"
+#include "RsssCrc8.h"
+#include "RsssCrc16.h"
+#include "RsssCrc32c.h"
+#include "RsssSync.h"
+
+#include <errno.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CRC8_SEED          0x78
+#define CRC8_SEED_CRC32C   0x87 // marks regions followed by a CRC32C tail
+#define CRC16_SEED       0x8795
+#define CRC32C_SEED      0x0000
+#define MIN_CHUNK      0x100000 // below this splitting costs more than it saves
+#define VERIFY_BATCH         64 // frames checked per task
+#define VERIFY_WINDOW     0x4000 // frames looked ahead per round
+
+
+using namespace rsss;
+
+
+static std::size_t tailSize(Tail tail) {
+  switch(tail) {
+    case Tail::Crc16:  return 2;
+    case Tail::Crc32c: return 4;
+    default:           return 0;
+  }
+}
+
+
+static bool verify(const std::uint8_t *data, const CapturedFrame &frame) {
+  auto payload = data + frame.offset + 4;
+  auto tail    = payload + frame.length;
+
+  switch(frame.tail) {
+    case Tail::Crc16:
+      return !calcCrc16(tail, 2, calcCrc16(payload, frame.length, CRC16_SEED));
+
+    case Tail::Crc32c:
+      return calcCrc32c(payload, frame.length, CRC32C_SEED) ==
+             (tail[0] | (tail[1] << 8) | (tail[2] << 16) | (static_cast<std::uint32_t>(tail[3]) << 24));
+
+    default:
+      return true;
+  }
+}
+
+
+std::vector<CapturedFrame> rsss::decodeCapture(const std::uint8_t *data, std::size_t size, Tail tail, std::uint16_t maxLength, ThreadPool &pool) {
+  std::vector<CapturedFrame> frames;
+  if(size < 4) {
+    return frames;
+  }
+
+  // marked headers only count for readers set to CRC32C, like in RSSS
+  const std::uint8_t markedSeed = tail == Tail::Crc32c ? CRC8_SEED_CRC32C : CRC8_SEED;
+
+  // every position that holds a valid header, whether or not it ends up
+  // inside another region, found chunk by chunk. A chunk owns the headers
+  // starting in it, and reads up to three bytes past its end to see them whole
+  const std::size_t workers = pool.size() + 1;
+  const std::size_t chunk   = std::max<std::size_t>(MIN_CHUNK, (size + workers * 4 - 1) / (workers * 4));
+  const std::size_t chunks  = (size + chunk - 1) / chunk;
+  std::vector<std::vector<std::uint64_t>> found(chunks);
+
+  pool.run(chunks, [&](std::size_t i) {
+    const std::size_t start = i * chunk;
+    const std::size_t end   = std::min(start + chunk, size);
+    const std::size_t limit = std::min(end + 3, size);
+
+    for(std::size_t at = start; at < end; ++at) {
+      at += scanSync(data + at, limit - at, CRC8_SEED, markedSeed);
+      if(at >= end || at + 4 > limit) {
+        break;
+      }
+      found[i].push_back(at);
+    }
+  });
+
+  std::vector<std::uint64_t> candidates;
+  for(auto &chunkFound: found) {
+    candidates.insert(candidates.end(), chunkFound.begin(), chunkFound.end());
+  }
+
+  // a tail verdict only depends on where its header is, so it is worked out
+  // once per candidate, when a walk first needs it
+  std::vector<std::int8_t> verdicts(candidates.size(), -1);
+  std::vector<std::size_t> pending;
+
+  auto frameAt = [&](std::size_t at) {
+    auto header = data + at;
+    auto length = static_cast<std::uint16_t>(header[1] | (header[2] << 8));
+
+    // unmarked regions carry a CRC16 tail only when both ends agree on it
+    auto plain = validateCrc8(header, 4, CRC8_SEED);
+    auto kind  = !plain ? Tail::Crc32c : tail == Tail::Crc16 ? Tail::Crc16 : Tail::None;
+
+    auto truncated = at + 4 + length + tailSize(kind) > size;
+
+    return CapturedFrame{ at, length, kind, kind == Tail::None && !truncated, truncated };
+  };
+
+  // walk the candidates the way a reader would, jumping from each header past
+  // its region and taking the first candidate at or behind that point. Regions
+  // failing their tail are rescanned from the byte after their sync byte, so
+  // the walk is done in rounds: a speculative one that assumes unchecked tails
+  // match and collects them, a parallel check of the collected tails, and the
+  // real one that stops at the first tail still unchecked
+  std::size_t index = 0;
+  std::size_t next  = 0;
+
+  while(index < candidates.size()) {
+    pending.clear();
+
+    for(std::size_t i = index, ahead = next; i < candidates.size() && pending.size() < VERIFY_WINDOW; ++i) {
+      auto frame = frameAt(candidates[i]);
+      if(frame.offset < ahead || frame.length > maxLength) {
+        continue;
+      }
+
+      ahead = frame.offset + 4;
+      if(!frame.length) {
+        continue;
+      }
+
+      if(frame.truncated) {
+        break;
+      }
+
+      if(frame.tail != Tail::None && verdicts[i] < 0) {
+        pending.push_back(i);
+      }
+
+      ahead = verdicts[i] == 0 ? frame.offset + 1 : frame.offset + 4 + frame.length + tailSize(frame.tail);
+    }
+
+    pool.run((pending.size() + VERIFY_BATCH - 1) / VERIFY_BATCH, [&](std::size_t batch) {
+      auto last = std::min(pending.size(), (batch + 1) * VERIFY_BATCH);
+
+      for(auto i = batch * VERIFY_BATCH; i < last; ++i) {
+        verdicts[pending[i]] = verify(data, frameAt(candidates[pending[i]]));
+      }
+    });
+
+    for(; index < candidates.size(); ++index) {
+      auto frame = frameAt(candidates[index]);
+      if(frame.offset < next || frame.length > maxLength) {
+        continue; // inside the last region, or too long to be real
+      }
+
+      next = frame.offset + 4;
+      if(!frame.length) {
+        continue; // empty regions carry nothing to report
+      }
+
+      if(frame.truncated) {
+        frames.push_back(frame);
+        return frames;
+      }
+
+      if(frame.tail != Tail::None) {
+        if(verdicts[index] < 0) {
+          next = frame.offset; // left for the next round
+          break;
+        }
+        frame.valid = verdicts[index] > 0;
+      }
+
+      frames.push_back(frame);
+      next = frame.valid ? frame.offset + 4 + frame.length + tailSize(frame.tail) : frame.offset + 1;
+    }
+  }
+
+  return frames;
+}
+
+
+Capture::Capture(const char *path):
+  base(nullptr),
+  length(0),
+  error(0) {
+  auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if(fd < 0) {
+    error = errno;
+    return;
+  }
+
+  struct stat info;
+  if(fstat(fd, &info) < 0) {
+    error = errno;
+  }
+  else if(info.st_size > 0) {
+    auto map = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(map != MAP_FAILED) {
+      base   = static_cast<const std::uint8_t *>(map);
+      length = static_cast<std::size_t>(info.st_size);
+
+      // every chunk gets read front to back once, by whichever thread takes it
+      madvise(map, length, MADV_WILLNEED);
+    }
+    else {
+      error = errno;
+    }
+  }
+
+  ::close(fd);
+}
+
+
+Capture::~Capture() {
+  if(base) {
+    munmap(const_cast<std::uint8_t *>(base), length);
+  }
+}
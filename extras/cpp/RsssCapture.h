@@ -0,0 +1,63 @@
+#ifndef RSSS_CAPTURE_H
+#  define RSSS_CAPTURE_H
+
+#  include "RSSS.h"
+#  include "RsssThreadPool.h"
+
+#  include <vector>
+#  include <cstddef>
+#  include <cstdint>
+
+
+namespace rsss {
+
+struct CapturedFrame {
+  std::uint64_t offset;    // of the sync header within the capture
+  std::uint16_t length;    // payload bytes
+  Tail          tail;
+  bool          valid;     // the tail CRC matched, always true without a tail
+  bool          truncated; // the capture ends inside the frame
+};
+
+
+// Decodes a raw capture of the receive side of a link into the frames, and
+// tail verdicts, that a sequential RSSS read loop using the given tail and
+// maximum length settings would produce. Chunks of the capture are scanned
+// for headers in parallel, the candidates are then stitched together in order
+// by jumping from one header past its region to the next, with the tails that
+// decide where to go after a region checked in parallel a window at a time.
+// Only the stitching looks at every frame in sequence, and it never touches
+// payload bytes.
+std::vector<CapturedFrame> decodeCapture(const std::uint8_t *, std::size_t, Tail, std::uint16_t maxLength = 0xFFFF,
+                                         ThreadPool &pool = ThreadPool::shared());
+
+
+// Read-only memory map of a whole capture file. Empty files map to nothing
+// and still count as ok().
+class Capture {
+  public:
+    explicit Capture(const char *path);
+    ~Capture();
+
+    Capture(const Capture &) = delete;
+    Capture &operator=(const Capture &) = delete;
+
+    bool                ok()   const { return !error; }
+    int                 err()  const { return error; } // errno of the failed open, fstat or mmap
+    const std::uint8_t *data() const { return base; }
+    std::size_t         size() const { return length; }
+
+    std::vector<CapturedFrame> decode(Tail t, std::uint16_t maxLength = 0xFFFF, ThreadPool &pool = ThreadPool::shared()) const {
+      return decodeCapture(base, length, t, maxLength, pool);
+    }
+
+  private:
+    const std::uint8_t *base;
+    std::size_t         length;
+    int                 error;
+};
+
+}
+
+
+#endif /* RSSS_CAPTURE_H */
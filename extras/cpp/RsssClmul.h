@@ -0,0 +1,67 @@
+#ifndef RSSS_CLMUL_H
+#  define RSSS_CLMUL_H
+
+#  include <cstddef>
+#  include <cstdint>
+
+#  if defined(__x86_64__) || defined(_M_X64)
+#    define RSSS_CRC_CLMUL 1
+#  else
+#    define RSSS_CRC_CLMUL 0
+#  endif
+
+
+namespace rsss {
+
+// Folding constants for a reflected CRC of up to 32 bits. Each pair holds
+// x^(D + 63) mod P and x^(D - 1) mod P, bit reversed into 64 bits, for a
+// folding distance of D bits.
+struct ClmulConstants {
+  std::uint64_t fold512[2];
+  std::uint64_t fold128[2];
+};
+
+
+constexpr std::uint64_t clmulPower(unsigned n, std::uint32_t poly, int width) {
+  const std::uint64_t top = 1ULL << width;
+  std::uint64_t rem = 1;
+
+  while(n-- > 0) {
+    rem <<= 1;
+    if(rem & top) {
+      rem ^= top | poly;
+    }
+  }
+
+  std::uint64_t reflected = 0;
+  for(int i = 0; i < 64; ++i) {
+    reflected |= ((rem >> i) & 1) << (63 - i);
+  }
+
+  return reflected;
+}
+
+
+// poly is given in its normal (MSB first) form without the leading term
+constexpr ClmulConstants clmulConstants(std::uint32_t poly, int width) {
+  return ClmulConstants{
+    { clmulPower(512 + 63, poly, width), clmulPower(512 - 1, poly, width) },
+    { clmulPower(128 + 63, poly, width), clmulPower(128 - 1, poly, width) }
+  };
+}
+
+
+bool hasClmul();
+
+// Folds all whole 16 byte blocks of data (len >= 64) into a single block
+// after mixing in the current CRC state. Running the table driven CRC over
+// the remainder with a zero seed, and then over the unconsumed tail of data,
+// yields the same result as running it over the whole buffer. Returns the
+// number of bytes consumed.
+std::size_t foldClmul(const std::uint8_t *data, std::size_t len, std::uint32_t crc,
+                      const ClmulConstants &k, std::uint8_t (&remainder)[16]);
+
+}
+
+
+#endif /* RSSS_CLMUL_H */
@@ -0,0 +1,251 @@
+#include "RsssCobs.h"
+#include "RsssCrc16.h"
+#include "RsssCrc32c.h"
+
+#include <errno.h>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <unistd.h>
+
+#define CRC16_SEED       0x8795
+#define CRC32C_SEED      0x0000
+#define READ_AHEAD      0x20000 // room for a whole stuffed frame with its delimiter
+
+
+using namespace rsss;
+
+
+static std::size_t tailSize(Tail tail) {
+  switch(tail) {
+    case Tail::Crc16:  return 2;
+    case Tail::Crc32c: return 4;
+    default:           return 0;
+  }
+}
+
+
+static std::uint32_t calcTail(Tail tail, const std::uint8_t *data, std::size_t count) {
+  switch(tail) {
+    case Tail::Crc16:  return calcCrc16(data, static_cast<int>(count), CRC16_SEED);
+    case Tail::Crc32c: return calcCrc32c(data, static_cast<int>(count), CRC32C_SEED);
+    default:           return 0;
+  }
+}
+
+
+// worst case size of a stuffed frame, one code byte per 254 bytes plus the
+// one opening the first group, not counting the delimiter
+static std::size_t stuffedSize(std::size_t size) {
+  return size + size / 254 + 1;
+}
+
+
+// append data to a stuffed frame in out, code is the offset of the code byte
+// of the group still open and at the offset of its next byte. Zeros close
+// the group they end, the code byte then holds the distance to them
+static void stuff(const std::uint8_t *data, std::size_t size, std::uint8_t *out, std::size_t &at, std::size_t &code) {
+  const std::uint8_t *end = data + size;
+
+  while(data != end) {
+    auto span = std::min<std::size_t>(0xFF - (at - code), end - data);
+    auto zero = static_cast<const std::uint8_t *>(memchr(data, 0, span));
+    auto run  = zero ? static_cast<std::size_t>(zero - data) : span;
+
+    memcpy(out + at, data, run);
+    at   += run;
+    data += run;
+
+    if(zero) {
+      out[code] = static_cast<std::uint8_t>(at - code);
+      code      = at++;
+      data     += 1;
+    }
+    else if(at - code == 0xFF) {
+      out[code] = 0xFF; // full group, no zero implied after it
+      code      = at++;
+    }
+  }
+}
+
+
+// decode a stuffed frame without its delimiter in place, returns the decoded
+// size or -1 when a code byte points past the end
+static long unstuff(std::uint8_t *data, std::size_t size) {
+  std::size_t in = 0, out = 0;
+
+  while(in < size) {
+    std::size_t code = data[in++];
+    if(code - 1 > size - in) {
+      return -1;
+    }
+
+    memmove(data + out, data + in, code - 1);
+    out += code - 1;
+    in  += code - 1;
+
+    if(code != 0xFF && in < size) {
+      data[out++] = 0;
+    }
+  }
+
+  return static_cast<long>(out);
+}
+
+
+Cobs::Cobs(int s, Tail t):
+  serial(s),
+  buffer(),
+  pending(),
+  sent(0),
+  head(0),
+  fill(0),
+  scan(0),
+  frame(0),
+  readSync(0),
+  maxLength(0xFFFF),
+  tail(t),
+  valid(t == Tail::None),
+  skipping(false) {}
+
+
+int Cobs::read(std::uint8_t *data, std::uint16_t length) {
+  if(!readSync) {
+    if(auto found = findFrame(); found <= 0) {
+      return found;
+    }
+  }
+
+  int count = std::min<int>(length, readSync);
+  memcpy(data, &buffer[frame], count);
+  frame    += count;
+  readSync -= count;
+
+  return count;
+}
+
+
+int Cobs::write(const std::uint8_t *data, std::uint16_t length) {
+  if(auto done = flush(); done <= 0) {
+    return done; // the last frame is still going out
+  }
+
+  if(length == 0) {
+    return 0;
+  }
+
+  const auto size = tailSize(tail);
+  std::uint8_t bytes[4];
+
+  for(std::size_t i = 0, crc = calcTail(tail, data, length); i < size; ++i, crc >>= 8) {
+    bytes[i] = static_cast<std::uint8_t>(crc);
+  }
+
+  pending.resize(stuffedSize(length + size) + 1);
+
+  std::size_t at = 1, code = 0;
+  stuff(data, length, pending.data(), at, code);
+  stuff(bytes, size, pending.data(), at, code);
+
+  pending[code] = static_cast<std::uint8_t>(at - code);
+  pending[at++] = 0;
+  pending.resize(at);
+  sent = 0;
+
+  return flush() < 0 ? -1 : length;
+}
+
+
+int Cobs::flush() {
+  while(sent < pending.size()) {
+    auto count = ::write(serial, &pending[sent], pending.size() - sent);
+
+    if(count < 0) {
+      return errno == EAGAIN ? 0 : -1; // blocking isn't an error
+    }
+
+    sent += count;
+  }
+
+  return 1;
+}
+
+
+// cut the next delimited frame out of the read buffer and decode it where it
+// is. Empty frames, malformed ones and ones too long to be real are dropped,
+// frames with a failed tail are returned with crcValid() false
+int Cobs::findFrame() {
+  const auto size = tailSize(tail);
+
+  while(true) {
+    auto delimiter = static_cast<std::uint8_t *>(fill > scan ? memchr(&buffer[scan], 0, fill - scan) : nullptr);
+
+    if(!delimiter) {
+      scan = fill;
+
+      if(fill - head > stuffedSize(maxLength + size)) {
+        head     = fill;
+        skipping = true; // too long to be real, drop it up to its delimiter
+      }
+
+      if(auto got = refill(); got <= 0) {
+        return got < 0 && errno != EAGAIN ? -1 : 0; // blocking isn't an error
+      }
+
+      continue;
+    }
+
+    auto begin = head;
+    auto end   = static_cast<std::size_t>(delimiter - buffer.data());
+    head = scan = end + 1;
+
+    if(std::exchange(skipping, false) || begin == end) {
+      continue;
+    }
+
+    auto decoded = unstuff(&buffer[begin], end - begin);
+    if(decoded < 0 || static_cast<std::size_t>(decoded) <= size || static_cast<std::size_t>(decoded) - size > maxLength) {
+      continue;
+    }
+
+    auto length = static_cast<std::size_t>(decoded) - size;
+    if(size) {
+      std::uint32_t crc = 0;
+      for(std::size_t i = size; i-- > 0; ) {
+        crc = (crc << 8) | buffer[begin + length + i];
+      }
+
+      valid = crc == calcTail(tail, &buffer[begin], length);
+    }
+
+    frame    = begin;
+    readSync = static_cast<std::uint16_t>(length);
+    return 1;
+  }
+}
+
+
+// move unread bytes to the front once the end is reached and read as much
+// as fits, only called between frames so nothing before head is needed
+ssize_t Cobs::refill() {
+  if(buffer.empty()) {
+    buffer.resize(READ_AHEAD);
+  }
+
+  if(head == fill) {
+    head = fill = scan = 0;
+  }
+  else if(fill == buffer.size()) {
+    memmove(&buffer[0], &buffer[head], fill - head);
+    fill -= head;
+    scan -= head;
+    head  = 0;
+  }
+
+  auto got = ::read(serial, &buffer[fill], buffer.size() - fill);
+  if(got > 0) {
+    fill += got;
+  }
+
+  return got;
+}
@@ -0,0 +1,67 @@
+#ifndef RSSS_COBS_H
+#  define RSSS_COBS_H
+
+#  include "RSSS.h"
+
+#  include <vector>
+#  include <cstddef>
+#  include <cstdint>
+
+
+namespace rsss {
+
+// Consistent Overhead Byte Stuffing framer with the same read/write API as
+// RSSS, for links that would rather pay one byte in 254 than a sync header.
+// Every frame, its optional tail CRC included, is stuffed so it holds no zero
+// bytes and is followed by a single 0x00 delimiter, so a receiver is back in
+// sync at the next delimiter no matter what the noise did. There is nothing
+// in the stream that marks the tail, both ends of a link have to agree on it.
+// Pick RSSS or Cobs per link, the two don't understand each other.
+//
+// write() takes whole frames only. The encoded frame is kept until the
+// descriptor took all of it, so after a short write on a non-blocking
+// descriptor the rest goes out with flush() or the next write().
+class Cobs {
+  public:
+    Cobs(int s, bool t = false): Cobs(s, t ? Tail::Crc16 : Tail::None) {}
+    Cobs(int s, Tail t);
+    Cobs(): Cobs(-1) {}
+
+    int  read(       std::uint8_t *, std::uint16_t); // wait for a delimited frame and then read its bytes
+    int  write(const std::uint8_t *, std::uint16_t); // stuff a whole frame and write it with its delimiter
+    bool crcValid() const { return valid; }
+
+    int  remaining() const { return readSync; } // bytes of the current frame not yet returned by read()
+
+    // frames decoding to more than this many bytes are taken for line noise
+    void setMaxLength(std::uint16_t length) { maxLength = length; }
+
+    // push what a short write left of the last frame, returns 1 once all of
+    // it is out, 0 when the descriptor can't take more yet and -1 on errors
+    int  flush();
+
+    explicit operator int() const { return serial; }
+
+  private:
+    int                       serial;
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::uint8_t> pending; // encoded frame on its way out
+    std::size_t               sent;
+    std::size_t               head;
+    std::size_t               fill;
+    std::size_t               scan;    // no delimiter between head and here
+    std::size_t               frame;   // offset of the decoded bytes not yet returned
+    std::uint16_t             readSync;
+    std::uint16_t             maxLength;
+    Tail                      tail;
+    bool                      valid;
+    bool                      skipping; // dropping an overlong frame up to its delimiter
+
+    int     findFrame();
+    ssize_t refill();
+};
+
+}
+
+
+#endif /* RSSS_COBS_H */
@@ -0,0 +1,194 @@
+#ifndef RSSS_CRC_TEMPLATE_H
+#  define RSSS_CRC_TEMPLATE_H
+
+#  include <array>
+#  include <cstddef>
+#  include <cstdint>
+#  include <type_traits>
+
+
+namespace rsss {
+
+namespace detail {
+
+constexpr std::uint32_t reflect(std::uint32_t value, int bits) {
+  std::uint32_t result = 0;
+  for(int i = 0; i < bits; ++i) {
+    result |= ((value >> i) & 1) << (bits - 1 - i);
+  }
+
+  return result;
+}
+
+
+// slices[n][i] is the CRC of byte i followed by n zero bytes
+template<typename T, int Width, std::uint32_t Poly, bool Reflect>
+constexpr std::array<std::array<T, 256>, 8> crcSlices() {
+  constexpr auto mask = ~0ULL >> (64 - Width);
+  std::array<std::array<T, 256>, 8> result{};
+
+  for(std::uint32_t i = 0; i < 256; ++i) {
+    std::uint64_t crc = 0;
+
+    if constexpr(Reflect) {
+      constexpr auto poly = reflect(Poly, Width);
+      crc = i;
+      for(int bit = 0; bit < 8; ++bit) {
+        crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+      }
+    }
+    else {
+      constexpr auto top = 1ULL << (Width - 1);
+      crc = static_cast<std::uint64_t>(i) << (Width - 8);
+      for(int bit = 0; bit < 8; ++bit) {
+        crc = (crc & top) ? (crc << 1) ^ Poly : crc << 1;
+      }
+    }
+
+    result[0][i] = static_cast<T>(crc & mask);
+  }
+
+  for(std::size_t n = 1; n < result.size(); ++n) {
+    for(std::size_t i = 0; i < 256; ++i) {
+      const std::uint64_t prev = result[n - 1][i];
+
+      if constexpr(Reflect) {
+        result[n][i] = static_cast<T>(result[0][prev & 0xFF] ^ (prev >> 8));
+      }
+      else {
+        result[n][i] = static_cast<T>((result[0][(prev >> (Width - 8)) & 0xFF] ^ (prev << 8)) & mask);
+      }
+    }
+  }
+
+  return result;
+}
+
+}
+
+
+// Table driven CRC of 8 to 32 bits with all tables generated at compile time.
+// Poly is given in its normal (MSB first) form without the leading term. The
+// seed accepted by calc() and the value it returns are both finished values,
+// so a calculation can be resumed by passing a previous result as the seed.
+template<int Width, std::uint32_t Poly, bool Reflect, std::uint32_t XorOut = 0>
+class Crc {
+  static_assert(Width >= 8 && Width <= 32, "unsupported CRC width");
+
+  public:
+    using value_type = std::conditional_t<(Width <= 8),  std::uint8_t,
+                       std::conditional_t<(Width <= 16), std::uint16_t, std::uint32_t>>;
+
+    static constexpr value_type mask = static_cast<value_type>(~0ULL >> (64 - Width));
+
+    // update the raw CRC register one byte at a time
+    static constexpr value_type update(value_type crc, const std::uint8_t *data, std::size_t len) {
+      while(len-- > 0) {
+        crc = step(crc, *data++);
+      }
+
+      return crc;
+    }
+
+    // update the raw CRC register eight bytes at a time
+    static value_type updateSliced(value_type crc, const std::uint8_t *data, std::size_t len) {
+      const auto &t = slices;
+
+      for(; len >= 8; len -= 8, data += 8) {
+        if constexpr(Reflect) {
+          const std::uint32_t v = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | static_cast<std::uint32_t>(data[3]) << 24);
+
+          crc = t[7][v & 0xFF] ^ t[6][(v >> 8) & 0xFF] ^ t[5][(v >> 16) & 0xFF] ^ t[4][v >> 24] ^
+                t[3][data[4]]  ^ t[2][data[5]]       ^ t[1][data[6]]         ^ t[0][data[7]];
+        }
+        else {
+          const std::uint32_t v = (static_cast<std::uint32_t>(crc) << (32 - Width)) ^
+                                  (static_cast<std::uint32_t>(data[0]) << 24 | data[1] << 16 | data[2] << 8 | data[3]);
+
+          crc = t[7][v >> 24]  ^ t[6][(v >> 16) & 0xFF] ^ t[5][(v >> 8) & 0xFF] ^ t[4][v & 0xFF] ^
+                t[3][data[4]]  ^ t[2][data[5]]          ^ t[1][data[6]]        ^ t[0][data[7]];
+        }
+      }
+
+      return update(crc, data, len);
+    }
+
+    static constexpr value_type calc(const std::uint8_t *data, std::size_t len, value_type seed) {
+      return update(seed ^ XorOut, data, len) ^ XorOut;
+    }
+
+    // advance the raw CRC register over len zero bytes in O(log(len)) steps
+    static constexpr value_type shift(value_type crc, std::uint64_t len) {
+      auto power = X8;
+
+      for(; len; len >>= 1) {
+        if(len & 1) {
+          crc = multiply(power, crc);
+        }
+
+        power = multiply(power, power);
+      }
+
+      return crc;
+    }
+
+    // calc() of two adjacent blocks, both started from the same seed, gives
+    // the calc() of the joined block without touching the data again
+    static constexpr value_type combine(value_type first, value_type second, std::uint64_t secondLen, value_type seed) {
+      return shift(first ^ seed, secondLen) ^ second;
+    }
+
+  private:
+    using Table = std::array<value_type, 256>;
+
+    static constexpr value_type step(value_type crc, std::uint8_t byte) {
+      if constexpr(Reflect) {
+        return table[(crc ^ byte) & 0xFF] ^ static_cast<value_type>(crc >> 8);
+      }
+      else {
+        return (table[((crc >> (Width - 8)) ^ byte) & 0xFF] ^ static_cast<value_type>(crc << 8)) & mask;
+      }
+    }
+
+    // multiply two polynomials modulo Poly using the register bit order
+    static constexpr value_type multiply(value_type a, value_type b) {
+      value_type product = 0;
+
+      for(int bit = 0; bit < Width; ++bit) {
+        if constexpr(Reflect) {
+          if((a >> (Width - 1 - bit)) & 1) {
+            product ^= b;
+          }
+
+          b = (b & 1) ? static_cast<value_type>((b >> 1) ^ detail::reflect(Poly, Width)) : static_cast<value_type>(b >> 1);
+        }
+        else {
+          if((a >> bit) & 1) {
+            product ^= b;
+          }
+
+          b = ((b >> (Width - 1)) & 1) ? static_cast<value_type>(((b << 1) ^ Poly) & mask) : static_cast<value_type>((b << 1) & mask);
+        }
+      }
+
+      return product;
+    }
+
+    // x^8 in the register bit order
+    static constexpr value_type X8 = Width == 8 ? static_cast<value_type>(Reflect ? detail::reflect(Poly, 8) : Poly)
+                                                : static_cast<value_type>(Reflect ? 1U << (Width - 9) : 1U << 8);
+
+  public:
+    static constexpr std::array<Table, 8> slices = detail::crcSlices<value_type, Width, Poly, Reflect>();
+    static constexpr Table                table  = slices[0];
+};
+
+
+using Crc8  = Crc< 8, 0x31,       true>;
+using Crc16 = Crc<16, 0x1021,     true>;
+using Crc32 = Crc<32, 0x04C11DB7, true, 0xFFFFFFFF>;
+
+}
+
+
+#endif /* RSSS_CRC_TEMPLATE_H */
@@ -0,0 +1,77 @@
+#include "RsssCrc32c.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define CRC32C_SSE42 1
+#  include <cstring>
+#  include <nmmintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define SSE42_TARGET
+#  else
+#    define SSE42_TARGET __attribute__((target("sse4.2")))
+#  endif
+#else
+#  define CRC32C_SSE42 0
+#endif
+
+
+using namespace rsss;
+
+
+#if CRC32C_SSE42
+
+static bool detectSse42() {
+#  ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#  else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+#  endif
+}
+
+
+bool rsss::hasCrc32cInstruction() {
+  static const bool supported = detectSse42();
+  return supported;
+}
+
+
+SSE42_TARGET static uint32_t updateSse42(uint32_t crc, const uint8_t *data, std::size_t len) {
+  std::uint64_t wide = crc;
+
+  for(; len >= 8; len -= 8, data += 8) {
+    std::uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    wide = _mm_crc32_u64(wide, word);
+  }
+
+  crc = static_cast<uint32_t>(wide);
+  while(len-- > 0) {
+    crc = _mm_crc32_u8(crc, *data++);
+  }
+
+  return crc;
+}
+
+#else
+
+bool rsss::hasCrc32cInstruction() {
+  return false;
+}
+
+#endif
+
+
+uint32_t rsss::calcCrc32c(const uint8_t *data, std::size_t len, uint32_t crc) {
+  crc ^= 0xFFFFFFFFU;
+
+#if CRC32C_SSE42
+  if(hasCrc32cInstruction()) {
+    return updateSse42(crc, data, len) ^ 0xFFFFFFFFU;
+  }
+#endif
+
+  return Crc32c::updateSliced(crc, data, len) ^ 0xFFFFFFFFU;
+}
@@ -0,0 +1,18 @@
+#ifndef RSSS_CRC32C_H
+#  define RSSS_CRC32C_H
+
+#  include "RsssCrc.h"
+
+
+namespace rsss {
+
+  using Crc32c = Crc<32, 0x1EDC6F41, true, 0xFFFFFFFF>;
+
+  // seed and result are finished values, so calculations can be chained
+  uint32_t calcCrc32c(const uint8_t *, std::size_t, uint32_t);
+
+  bool hasCrc32cInstruction();
+
+}
+
+#endif /* RSSS_CRC32C_H */
@@ -1,15 +1,25 @@
 #ifndef RSSS_CRC8_H
 #  define RSSS_CRC8_H
 
-#  include <cstdint>
+#  include "RsssCrc.h"
 
 
 namespace rsss {
 
 
-uint8_t calcCrc8(const uint8_t *data, int len, uint8_t crc);
-uint8_t appendCrc8(uint8_t *data, int len, uint8_t crc);
-bool    validateCrc8(const uint8_t *data, int len, uint8_t crc);
+inline uint8_t calcCrc8(const uint8_t *data, int len, uint8_t crc) {
+  return len > 0 ? Crc8::update(crc, data, len) : crc;
+}
+
+
+inline uint8_t appendCrc8(uint8_t *data, int len, uint8_t crc) {
+  return data[len] = calcCrc8(data, len, crc);
+}
+
+
+inline bool validateCrc8(const uint8_t *data, int len, uint8_t crc) {
+  return !calcCrc8(data, len, crc);
+}
 
 
 }
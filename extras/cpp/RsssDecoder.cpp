@@ -0,0 +1,160 @@
+#include "RsssDecoder.h"
+#include "RsssCrc8.h"
+#include "RsssCrc16.h"
+#include "RsssCrc32c.h"
+#include "RsssSync.h"
+
+#include <cstring>
+#include <algorithm>
+
+#define CRC8_SEED          0x78
+#define CRC8_SEED_CRC32C   0x87 // marks regions followed by a CRC32C tail
+#define CRC16_SEED       0x8795
+#define CRC32C_SEED      0x0000
+
+
+using namespace rsss;
+
+
+Decoder::Decoder(Sink &s, Tail t):
+  sink(&s),
+  window{ 0, 0, 0, 0 },
+  tailBytes{ 0, 0, 0, 0 },
+  crc(0),
+  remaining(0),
+  held(0),
+  tailHave(0),
+  tail(t),
+  frameTail(t),
+  state(State::Hunting) {}
+
+
+void Decoder::feed(const std::uint8_t *data, std::size_t len) {
+  while(len > 0) {
+    std::size_t used = 0;
+
+    switch(state) {
+      case State::Hunting:
+        used = hunt(data, len);
+        break;
+
+      case State::Payload:
+        used = std::min<std::size_t>(len, remaining);
+        sink->frameData(data, used);
+
+        if(frameTail == Tail::Crc16) {
+          crc = calcCrc16(data, static_cast<int>(used), static_cast<std::uint16_t>(crc));
+        }
+        else if(frameTail == Tail::Crc32c) {
+          crc = calcCrc32c(data, used, crc);
+        }
+
+        if(!(remaining -= static_cast<std::uint16_t>(used))) {
+          if(frameTail == Tail::None) {
+            end(true);
+          }
+          else {
+            state = State::Tail;
+          }
+        }
+        break;
+
+      case State::Tail: {
+        const std::size_t size = frameTail == Tail::Crc16 ? 2 : 4;
+        used = std::min<std::size_t>(len, size - tailHave);
+        memcpy(&tailBytes[tailHave], data, used);
+
+        if((tailHave += static_cast<std::uint8_t>(used)) == size) {
+          if(frameTail == Tail::Crc16) {
+            end(!calcCrc16(&tailBytes[0], 2, static_cast<std::uint16_t>(crc)));
+          }
+          else {
+            end(crc == (tailBytes[0] | (tailBytes[1] << 8) | (tailBytes[2] << 16) | (static_cast<std::uint32_t>(tailBytes[3]) << 24)));
+          }
+        }
+        break;
+      }
+    }
+
+    data += used;
+    len  -= used;
+  }
+}
+
+
+void Decoder::reset() {
+  held      = 0;
+  remaining = 0;
+  tailHave  = 0;
+  state     = State::Hunting;
+}
+
+
+// look for a header, returning how many bytes were used up
+std::size_t Decoder::hunt(const std::uint8_t *data, std::size_t len) {
+  // marked headers only count for readers set to CRC32C, like in RSSS
+  const std::uint8_t markedSeed = tail == Tail::Crc32c ? CRC8_SEED_CRC32C : CRC8_SEED;
+
+  if(held) {
+    // headers may straddle feeds, so check the carried bytes joined with
+    // the start of this chunk before scanning the chunk itself
+    std::uint8_t joined[6];
+    const std::size_t take = std::min<std::size_t>(len, 3);
+    const std::size_t size = held + take;
+
+    memcpy(&joined[0], &window[0], held);
+    memcpy(&joined[held], data, take);
+
+    auto at = scanSync(joined, size, CRC8_SEED, markedSeed);
+    if(at < held && at + 4 <= size) {
+      auto used = at + 4 - held;
+      held = 0;
+      begin(&joined[at]);
+      return used;
+    }
+
+    if(take < 3) {
+      // still not enough to rule out the carried bytes
+      held = static_cast<std::uint8_t>(size - at);
+      memmove(&window[0], &joined[at], held);
+      return take;
+    }
+
+    held = 0; // every header starting in the carried bytes was ruled out
+  }
+
+  auto at = scanSync(data, len, CRC8_SEED, markedSeed);
+  if(at + 4 <= len) {
+    begin(&data[at]);
+    return at + 4;
+  }
+
+  // keep the bytes that might still start a header
+  held = static_cast<std::uint8_t>(len - at);
+  memcpy(&window[0], &data[at], held);
+  return len;
+}
+
+
+void Decoder::begin(const std::uint8_t *header) {
+  const bool plain = validateCrc8(header, 4, CRC8_SEED);
+
+  // unmarked regions carry a CRC16 tail only when both ends agree on it
+  frameTail = !plain ? Tail::Crc32c : tail == Tail::Crc16 ? Tail::Crc16 : Tail::None;
+  crc       = !plain ? CRC32C_SEED  : CRC16_SEED;
+  remaining = static_cast<std::uint16_t>(header[1] | (header[2] << 8));
+  tailHave  = 0;
+
+  if(!remaining) {
+    return; // empty regions carry nothing to report
+  }
+
+  state = State::Payload;
+  sink->frameBegin(remaining);
+}
+
+
+void Decoder::end(bool valid) {
+  state = State::Hunting;
+  sink->frameEnd(valid);
+}
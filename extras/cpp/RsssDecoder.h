@@ -0,0 +1,63 @@
+#ifndef RSSS_DECODER_H
+#  define RSSS_DECODER_H
+
+#  include "RSSS.h"
+
+#  include <array>
+#  include <cstddef>
+#  include <cstdint>
+
+
+namespace rsss {
+
+// Frame parser without any I/O. Bytes from any transport are pushed in with
+// feed(), in chunks of any size, and each synchronized region is reported to
+// the Sink as frameBegin(), zero or more frameData() fragments pointing into
+// the fed buffer, and frameEnd() with the tail CRC verdict. Regions without a
+// tail always end valid. Everything happens inside feed(), in one pass over
+// the buffer, so fragments are only valid for the duration of the callback.
+class Decoder {
+  public:
+    class Sink {
+      public:
+        virtual ~Sink() = default;
+
+        virtual void frameBegin(std::uint16_t length) = 0;
+        virtual void frameData(const std::uint8_t *data, std::size_t size) = 0;
+        virtual void frameEnd(bool valid) = 0;
+    };
+
+    explicit Decoder(Sink &s, Tail t = Tail::None);
+
+    void feed(const std::uint8_t *, std::size_t);
+    void reset(); // drop any partial header or frame without reporting it
+
+    bool inFrame() const { return state != State::Hunting; }
+
+  private:
+    enum class State : std::uint8_t {
+      Hunting,
+      Payload,
+      Tail
+    };
+
+    Sink                       *sink;
+    std::array<std::uint8_t, 4> window;   // header bytes carried over between feeds
+    std::array<std::uint8_t, 4> tailBytes;
+    std::uint32_t               crc;
+    std::uint16_t               remaining;
+    std::uint8_t                held;
+    std::uint8_t                tailHave;
+    Tail                        tail;
+    Tail                        frameTail;
+    State                       state;
+
+    std::size_t hunt(const std::uint8_t *, std::size_t);
+    void        begin(const std::uint8_t *);
+    void        end(bool);
+};
+
+}
+
+
+#endif /* RSSS_DECODER_H */
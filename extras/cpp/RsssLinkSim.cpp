@@ -0,0 +1,240 @@
+#include "RsssLinkSim.h"
+
+#include <deque>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+
+using namespace rsss;
+
+using Clock = std::chrono::steady_clock;
+
+
+namespace {
+
+struct Pending {
+  Clock::time_point arrival;
+  std::uint8_t      byte;
+};
+
+
+// one direction of the link, from the inner end of one pair to the other
+struct Direction {
+  int                       source;
+  int                       sink;
+  std::deque<Pending>       queue;
+  std::vector<std::uint8_t> outbox;
+  Clock::time_point         wireFree;
+  Clock::time_point         lastArrival;
+  std::mt19937_64           errors;
+  std::mt19937_64           timing;
+  bool                      burst;
+  bool                      eof;
+};
+
+
+Clock::duration seconds(double value) {
+  return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(value));
+}
+
+
+bool chance(std::mt19937_64 &rng, double p) {
+  return p > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p;
+}
+
+}
+
+
+LinkSim::LinkSim(const LinkModel &m):
+  model(m),
+  ends{ -1, -1 },
+  inner{ -1, -1 },
+  wake{ -1, -1 },
+  counters(),
+  shaper() {
+  int a[2], b[2];
+
+  if(socketpair(AF_UNIX, SOCK_STREAM, 0, a) != 0) {
+    return;
+  }
+
+  if(socketpair(AF_UNIX, SOCK_STREAM, 0, b) != 0 || pipe(&wake[0]) != 0) {
+    close(a[0]);
+    close(a[1]);
+    return;
+  }
+
+  ends  = { a[0], b[0] };
+  inner = { a[1], b[1] };
+
+  // keep the kernel from buffering far ahead of the simulated wire
+  for(auto fd: ends) {
+    int size = static_cast<int>(std::max<std::size_t>(model.fifo, 1024));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+  }
+
+  for(auto fd: { inner[0], inner[1], wake[0] }) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+
+  shaper = std::thread(&LinkSim::shape, this);
+}
+
+
+LinkSim::~LinkSim() {
+  if(shaper.joinable()) {
+    std::uint8_t stop = 0;
+    ::write(wake[1], &stop, 1);
+    shaper.join();
+  }
+
+  for(auto fd: { ends[0], ends[1], inner[0], inner[1], wake[0], wake[1] }) {
+    if(fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+
+LinkStats LinkSim::stats(int from) const {
+  auto &c = counters[from & 1];
+  return { c.bytes.load(), c.dropped.load(), c.corrupted.load(), c.flips.load() };
+}
+
+
+void LinkSim::shape() {
+  const auto byteTime = model.baud ? seconds(10.0 / model.baud) : Clock::duration::zero();
+  const auto latency  = seconds(model.latency);
+  const auto now      = Clock::now();
+
+  std::array<Direction, 2> dirs{ {
+    { inner[0], inner[1], {}, {}, now, now, std::mt19937_64(model.seed),     std::mt19937_64(~model.seed),     false, false },
+    { inner[1], inner[0], {}, {}, now, now, std::mt19937_64(model.seed + 1), std::mt19937_64(~model.seed - 1), false, false },
+  } };
+
+  std::vector<std::uint8_t> chunk(std::max<std::size_t>(model.fifo, 1));
+
+  while(true) {
+    auto current = Clock::now();
+    auto wakeAt  = Clock::time_point::max();
+    bool busy    = false;
+    std::array<pollfd, 5> fds;
+    nfds_t count = 0;
+
+    for(int d = 0; d < 2; ++d) {
+      auto &dir = dirs[d];
+      auto &stat = counters[d];
+
+      // move everything that has arrived to the outbox and push it out
+      while(!dir.queue.empty() && dir.queue.front().arrival <= current) {
+        dir.outbox.push_back(dir.queue.front().byte);
+        dir.queue.pop_front();
+      }
+
+      if(!dir.outbox.empty()) {
+        if(auto sent = send(dir.sink, dir.outbox.data(), dir.outbox.size(), MSG_NOSIGNAL); sent > 0) {
+          dir.outbox.erase(dir.outbox.begin(), dir.outbox.begin() + sent);
+        }
+        else if(sent < 0 && errno != EAGAIN) {
+          dir.outbox.clear(); // the receiver has gone away
+        }
+      }
+
+      // accept no more than fits in the FIFO ahead of the wire
+      std::size_t space = chunk.size();
+      if(byteTime.count() > 0 && dir.wireFree > current) {
+        auto ahead = static_cast<std::size_t>((dir.wireFree - current) / byteTime);
+        space = ahead < space ? space - ahead : 0;
+      }
+
+      if(space > 0 && !dir.eof) {
+        auto got = ::read(dir.source, chunk.data(), space);
+
+        if(got == 0) {
+          dir.eof = true;
+        }
+
+        for(ssize_t i = 0; i < got; ++i) {
+          auto depart = std::max(dir.wireFree, current);
+          dir.wireFree = depart + byteTime;
+
+          // state changes happen per byte, before the byte is damaged
+          dir.burst = dir.burst ? !chance(dir.errors, model.burstExit) : chance(dir.errors, model.burstEnter);
+
+          auto rate = dir.burst ? model.burstError : model.bitError;
+          auto byte = chunk[i];
+          int flips = 0;
+          for(int bit = 0; rate > 0.0 && bit < 8; ++bit) {
+            if(chance(dir.errors, rate)) {
+              byte ^= 1 << bit;
+              ++flips;
+            }
+          }
+
+          ++stat.bytes;
+          if(chance(dir.errors, model.drop)) {
+            ++stat.dropped;
+            continue; // still took its time on the wire
+          }
+
+          if(flips) {
+            ++stat.corrupted;
+            stat.flips += flips;
+          }
+
+          auto arrival = dir.wireFree + latency;
+          if(model.jitter > 0.0) {
+            arrival += seconds(std::uniform_real_distribution<double>(0.0, model.jitter)(dir.timing));
+          }
+
+          dir.lastArrival = std::max(arrival, dir.lastArrival);
+          dir.queue.push_back({ dir.lastArrival, byte });
+        }
+
+        busy = busy || got > 0; // look again before sleeping
+      }
+
+      // a closed sender closes the receiving side once everything has arrived
+      if(dir.eof && dir.queue.empty() && dir.outbox.empty()) {
+        shutdown(dir.sink, SHUT_WR);
+      }
+
+      if(!dir.queue.empty()) {
+        wakeAt = std::min(wakeAt, dir.queue.front().arrival);
+      }
+
+      if(!space && !dir.eof) {
+        wakeAt = std::min(wakeAt, dir.wireFree - byteTime * static_cast<long>(chunk.size() / 2));
+      }
+      else if(!dir.eof) {
+        fds[count++] = { dir.source, POLLIN, 0 };
+      }
+
+      if(!dir.outbox.empty()) {
+        fds[count++] = { dir.sink, POLLOUT, 0 };
+      }
+    }
+
+    fds[count++] = { wake[0], POLLIN, 0 };
+
+    timespec timeout{ 0, 0 }, *wait = nullptr;
+    if(busy || wakeAt != Clock::time_point::max()) {
+      auto ns = busy ? 0 : std::chrono::duration_cast<std::chrono::nanoseconds>(wakeAt - Clock::now()).count();
+      if(ns > 0) {
+        timeout = { static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+      }
+      wait = &timeout;
+    }
+
+    if(ppoll(fds.data(), count, wait, nullptr) > 0 && (fds[count - 1].revents & POLLIN)) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef RSSS_LINK_SIM_H
+#  define RSSS_LINK_SIM_H
+
+#  include <array>
+#  include <atomic>
+#  include <chrono>
+#  include <cstdint>
+#  include <thread>
+
+
+namespace rsss {
+
+// Impairments applied to each direction of a simulated serial link. Error
+// draws depend only on the byte sequence and the seed, so a given stream of
+// bytes is always damaged the same way regardless of scheduling.
+struct LinkModel {
+  std::uint32_t baud     = 115200; // 10 bits per byte (8N1), 0 disables throttling
+  double        latency  = 0.0;    // fixed delay in seconds
+  double        jitter   = 0.0;    // uniform extra delay in seconds, never reorders bytes
+  double        bitError = 0.0;    // chance of flipping each bit in the good state
+
+  // Gilbert-Elliott burst errors, the link enters the bad state with chance
+  // burstEnter per byte, leaves it with chance burstExit per byte and flips
+  // bits with chance burstError while in it
+  double        burstEnter = 0.0;
+  double        burstExit  = 0.1;
+  double        burstError = 0.5;
+
+  double        drop   = 0.0;      // chance of losing each byte outright
+  std::size_t   fifo   = 256;      // bytes accepted ahead of the wire, like a UART FIFO
+  std::uint64_t seed   = 1;
+};
+
+
+struct LinkStats {
+  std::uint64_t bytes;     // bytes accepted from the sender
+  std::uint64_t dropped;   // bytes lost outright
+  std::uint64_t corrupted; // bytes delivered with at least one flipped bit
+  std::uint64_t flips;     // total flipped bits
+};
+
+
+// A pair of connected file descriptors with a shaping thread in between that
+// imposes a LinkModel on both directions. Bytes written to end(0) arrive at
+// end(1) and vice versa.
+class LinkSim {
+  public:
+    explicit LinkSim(const LinkModel & = LinkModel());
+    ~LinkSim();
+
+    LinkSim(const LinkSim &) = delete;
+    LinkSim &operator=(const LinkSim &) = delete;
+
+    bool      ok() const { return ends[0] >= 0; }
+    int       end(int side) const { return ends[side & 1]; }
+    LinkStats stats(int from) const; // for bytes written to end(from)
+
+  private:
+    struct Counters {
+      std::atomic<std::uint64_t> bytes{ 0 };
+      std::atomic<std::uint64_t> dropped{ 0 };
+      std::atomic<std::uint64_t> corrupted{ 0 };
+      std::atomic<std::uint64_t> flips{ 0 };
+    };
+
+    LinkModel               model;
+    std::array<int, 2>      ends;
+    std::array<int, 2>      inner;
+    std::array<int, 2>      wake;
+    std::array<Counters, 2> counters;
+    std::thread             shaper;
+
+    void shape();
+};
+
+}
+
+
+#endif /* RSSS_LINK_SIM_H */
@@ -0,0 +1,116 @@
+#include "RsssPacer.h"
+
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#define PUMP_BATCH      64 // frames handed to writeFrames() at a time
+
+
+using namespace rsss;
+
+
+// 10 bits a byte on the line, 8N1
+Pacer::Pacer(RSSS &l, std::uint32_t baud, int delay):
+  link(&l),
+  rate(std::max<std::uint32_t>(baud / 10, 1)),
+  budget(std::max<std::size_t>(static_cast<std::size_t>(rate) * std::max(delay, 0) / 1000, 1)),
+  overhead(4 + (l.tailType() == Tail::Crc32c ? 4 : l.tailType() == Tail::Crc16 ? 2 : 0)),
+  level(0),
+  counted(isatty(static_cast<int>(l)) == 1),
+  drained(std::chrono::steady_clock::now()),
+  urgent(),
+  bulk() {}
+
+
+void Pacer::queue(const std::uint8_t *data, std::uint16_t length, bool first) {
+  (first ? urgent : bulk).emplace_back(data, data + length);
+}
+
+
+int Pacer::pump() {
+  if(auto done = link->flush(); done <= 0) {
+    return done; // the rest of a frame a short write cut goes first
+  }
+
+  const auto queued = outstanding();
+
+  std::array<Span, PUMP_BATCH> spans;
+  std::size_t count = 0, early = 0, bytes = 0;
+
+  // frames go in order, the first one that doesn't fit holds back the rest
+  for(auto *held: { &urgent, &bulk }) {
+    for(auto &frame: *held) {
+      auto size = frame.size() + overhead;
+
+      if(count == spans.size() || (queued + bytes && queued + bytes + size > budget)) {
+        goto full;
+      }
+
+      spans[count++] = { frame.data(), frame.size() };
+      bytes         += size;
+      early         += held == &urgent;
+    }
+  }
+
+full:
+  if(!count) {
+    return 0;
+  }
+
+  auto sent = link->writeFrames(spans.data(), count);
+  if(sent < 0 && errno == EBUSY) {
+    return 0; // write() has a region open, hold on to everything until it closes
+  }
+
+  for(int i = 0; i < sent; ++i) {
+    auto &held = static_cast<std::size_t>(i) < early ? urgent : bulk;
+
+    level += held.front().size() + overhead;
+    held.pop_front();
+  }
+
+  return sent;
+}
+
+
+int Pacer::wait() {
+  auto next = front();
+  if(!next) {
+    return -1;
+  }
+
+  const auto queued = outstanding();
+  const auto size   = next->size() + overhead;
+
+  if(!queued || queued + size <= budget) {
+    return 0;
+  }
+
+  // drain until the frame fits, or all the way for one larger than the budget
+  auto excess = queued - (size < budget ? budget - size : 0);
+  return static_cast<int>(std::ceil(excess * 1000.0 / rate));
+}
+
+
+std::size_t Pacer::outstanding() {
+  auto now = std::chrono::steady_clock::now();
+  level    = std::max(0.0, level - std::chrono::duration<double>(now - drained).count() * rate);
+  drained  = now;
+
+  // sockets answer TIOCOUTQ with buffer memory, overhead included, not bytes
+  int reported = 0;
+  if(!counted || ioctl(static_cast<int>(*link), TIOCOUTQ, &reported) != 0) {
+    reported = 0;
+  }
+
+  return std::max(static_cast<std::size_t>(std::max(reported, 0)), static_cast<std::size_t>(std::ceil(level)));
+}
+
+
+const std::vector<std::uint8_t> *Pacer::front() const {
+  return !urgent.empty() ? &urgent.front() : !bulk.empty() ? &bulk.front() : nullptr;
+}
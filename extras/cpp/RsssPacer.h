@@ -0,0 +1,63 @@
+#ifndef RSSS_PACER_H
+#  define RSSS_PACER_H
+
+#  include "RSSS.h"
+
+#  include <deque>
+#  include <chrono>
+#  include <vector>
+#  include <cstddef>
+#  include <cstdint>
+
+
+namespace rsss {
+
+// Transmit pacer for an RSSS on a serial line. Frames are held in user space
+// and only handed to the RSSS while the descriptor's output queue holds less
+// than delay milliseconds worth of bytes at the line rate, so the driver never
+// sits on seconds of bulk data and an urgent frame queued now goes out within
+// about delay milliseconds plus one frame, ahead of everything still held.
+// The output queue is taken as the larger of what TIOCOUTQ reports and what
+// the line rate says should still be in flight, the first covers flow control
+// and slow drivers, the second descriptors that can't tell. TIOCOUTQ is only
+// asked on terminals, anything else goes by the line rate alone.
+class Pacer {
+  public:
+    Pacer(RSSS &link, std::uint32_t baud, int delay);
+
+    // hold a copy of a frame until pump() hands it over, urgent frames go
+    // ahead of all others, in the order they were queued
+    void queue(const std::uint8_t *, std::uint16_t, bool urgent = false);
+
+    // hand over as many held frames as fit below the delay, returns how many
+    // did, or -1 on errors. A frame larger than the delay allows goes out on
+    // its own once the queue is empty. While write() has a region open on
+    // the RSSS nothing is handed over and 0 is returned, so finish that
+    // region before relying on wait()
+    int  pump();
+
+    // milliseconds until pump() can hand over the next frame, 0 when it can
+    // now and -1 when nothing is held; use it as the poll() timeout
+    int  wait();
+
+    std::size_t held() const { return urgent.size() + bulk.size(); }
+
+  private:
+    RSSS                                  *link;
+    std::uint32_t                          rate;     // bytes per second
+    std::size_t                            budget;   // bytes the delay allows
+    std::size_t                            overhead; // sync header and tail bytes per frame
+    double                                 level;    // bytes on their way out as far as the line rate knows
+    bool                                   counted;  // TIOCOUTQ reports bytes, the descriptor is a terminal
+    std::chrono::steady_clock::time_point  drained;
+    std::deque<std::vector<std::uint8_t>>  urgent;
+    std::deque<std::vector<std::uint8_t>>  bulk;
+
+    std::size_t outstanding();
+    const std::vector<std::uint8_t> *front() const;
+};
+
+}
+
+
+#endif /* RSSS_PACER_H */
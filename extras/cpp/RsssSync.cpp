@@ -0,0 +1,244 @@
+#include "RsssSync.h"
+#include "RsssCrc8.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define SYNC_X86 1
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define AVX2_TARGET
+#  else
+#    define AVX2_TARGET __attribute__((target("avx2")))
+#  endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define SYNC_NEON 1
+#  include <arm_neon.h>
+#endif
+
+
+using namespace rsss;
+
+
+// The CRC8 of a header 0xAA b c d is zero when d == K ^ T[T[b]] ^ T[c], where
+// T is the byte table and K depends only on the seed. T is linear, so each
+// lookup also splits into one lookup per nibble, which is what the vector
+// scanners do with byte shuffles.
+struct Nibbles {
+  std::uint8_t once[2][16];  // T[n], T[n << 4]
+  std::uint8_t twice[2][16]; // T[T[n]], T[T[n << 4]]
+};
+
+
+static constexpr Nibbles nibbles() {
+  Nibbles result{};
+
+  for(int n = 0; n < 16; ++n) {
+    result.once[0][n]  = Crc8::table[n];
+    result.once[1][n]  = Crc8::table[n << 4];
+    result.twice[0][n] = Crc8::table[Crc8::table[n]];
+    result.twice[1][n] = Crc8::table[Crc8::table[n << 4]];
+  }
+
+  return result;
+}
+
+
+static constexpr Nibbles NIBBLES = nibbles();
+
+
+static std::uint8_t key(std::uint8_t seed) {
+  return Crc8::table[Crc8::table[Crc8::table[seed ^ 0xAA]]];
+}
+
+
+static inline bool match(const std::uint8_t *p, std::uint8_t a, std::uint8_t b) {
+  if(p[0] != 0xAA) {
+    return false;
+  }
+
+  const std::uint8_t v = Crc8::table[Crc8::table[p[1]]] ^ Crc8::table[p[2]] ^ p[3];
+  return v == a || v == b;
+}
+
+
+#if SYNC_X86 || SYNC_NEON
+
+// for the few bytes left over by the vector scanners
+static std::size_t scanTail(const std::uint8_t *data, std::size_t start, std::size_t len, std::uint8_t a, std::uint8_t b) {
+  for(auto i = start; i + 4 <= len; ++i) {
+    if(match(&data[i], a, b)) {
+      return i;
+    }
+  }
+
+  return len >= 3 ? len - 3 : 0;
+}
+
+#endif
+
+
+#if SYNC_X86
+
+static inline unsigned firstBit(std::uint64_t mask) {
+#  ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, mask);
+  return index;
+#  else
+  return __builtin_ctzll(mask);
+#  endif
+}
+
+
+static bool detectAvx2() {
+#  ifdef _MSC_VER
+  int info[4];
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#  else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#  endif
+}
+
+
+// SSE2 lacks a byte shuffle, so only the 0xAA search is vectorized
+static std::size_t scanSse2(const std::uint8_t *data, std::size_t len, std::uint8_t a, std::uint8_t b) {
+  const auto marker = _mm_set1_epi8(static_cast<char>(0xAA));
+  std::size_t i = 0;
+
+  for(; i + 16 + 3 <= len; i += 16) {
+    auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&data[i]));
+
+    for(auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, marker))); mask; mask &= mask - 1) {
+      auto at = i + firstBit(mask);
+      if(match(&data[at], a, b)) {
+        return at;
+      }
+    }
+  }
+
+  return scanTail(data, i, len, a, b);
+}
+
+
+AVX2_TARGET static inline __m256i load(const std::uint8_t *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+
+AVX2_TARGET static inline __m256i lookup(const std::uint8_t (&table)[2][16], __m256i x) {
+  const auto low = _mm256_set1_epi8(0x0F);
+  const auto lo  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table[0])));
+  const auto hi  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table[1])));
+
+  return _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, low)),
+                          _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+}
+
+
+AVX2_TARGET static inline __m256i validate(const std::uint8_t *p, __m256i found, __m256i keyA, __m256i keyB) {
+  auto v = _mm256_xor_si256(_mm256_xor_si256(lookup(NIBBLES.twice, load(p + 1)), lookup(NIBBLES.once, load(p + 2))), load(p + 3));
+  return _mm256_and_si256(found, _mm256_or_si256(_mm256_cmpeq_epi8(v, keyA), _mm256_cmpeq_epi8(v, keyB)));
+}
+
+
+// validates all 64 positions of a block at once, blocks are twice the vector
+// width so that line noise, with a marker every 256 bytes, mostly skips them
+AVX2_TARGET static std::size_t scanAvx2(const std::uint8_t *data, std::size_t len, std::uint8_t a, std::uint8_t b) {
+  const auto marker = _mm256_set1_epi8(static_cast<char>(0xAA));
+  const auto keyA   = _mm256_set1_epi8(static_cast<char>(a));
+  const auto keyB   = _mm256_set1_epi8(static_cast<char>(b));
+  std::size_t i = 0;
+
+  for(; i + 64 + 3 <= len; i += 64) {
+    auto low  = _mm256_cmpeq_epi8(load(&data[i]),      marker);
+    auto high = _mm256_cmpeq_epi8(load(&data[i + 32]), marker);
+    auto any  = _mm256_or_si256(low, high);
+
+    if(_mm256_testz_si256(any, any)) {
+      continue;
+    }
+
+    low  = validate(&data[i],      low,  keyA, keyB);
+    high = validate(&data[i + 32], high, keyA, keyB);
+
+    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(low)) |
+                static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(high))) << 32;
+    if(mask) {
+      return i + firstBit(mask);
+    }
+  }
+
+  return scanTail(data, i, len, a, b);
+}
+
+#elif SYNC_NEON
+
+static inline uint8x16_t lookup(const std::uint8_t (&table)[2][16], uint8x16_t x) {
+  return veorq_u8(vqtbl1q_u8(vld1q_u8(table[0]), vandq_u8(x, vdupq_n_u8(0x0F))),
+                  vqtbl1q_u8(vld1q_u8(table[1]), vshrq_n_u8(x, 4)));
+}
+
+
+// validates all 16 positions of a block at once
+static std::size_t scanNeon(const std::uint8_t *data, std::size_t len, std::uint8_t a, std::uint8_t b) {
+  const auto marker = vdupq_n_u8(0xAA);
+  const auto keyA   = vdupq_n_u8(a);
+  const auto keyB   = vdupq_n_u8(b);
+  std::size_t i = 0;
+
+  for(; i + 16 + 3 <= len; i += 16) {
+    auto found = vceqq_u8(vld1q_u8(&data[i]), marker);
+    if(!vmaxvq_u8(found)) {
+      continue; // most blocks of line noise have no marker at all
+    }
+
+    auto v = veorq_u8(veorq_u8(lookup(NIBBLES.twice, vld1q_u8(&data[i + 1])), lookup(NIBBLES.once, vld1q_u8(&data[i + 2]))),
+                      vld1q_u8(&data[i + 3]));
+    found  = vandq_u8(found, vorrq_u8(vceqq_u8(v, keyA), vceqq_u8(v, keyB)));
+
+    if(vmaxvq_u8(found)) {
+      return scanTail(data, i, i + 16 + 3, a, b); // there is no movemask, but a hit is certain
+    }
+  }
+
+  return scanTail(data, i, len, a, b);
+}
+
+#else
+
+static std::size_t scanScalar(const std::uint8_t *data, std::size_t start, std::size_t len, std::uint8_t a, std::uint8_t b) {
+  for(auto i = start; i + 4 <= len; ++i) {
+    auto hit = static_cast<const std::uint8_t *>(memchr(&data[i], 0xAA, len - 3 - i));
+    if(!hit) {
+      break;
+    }
+
+    i = hit - data;
+    if(match(hit, a, b)) {
+      return i;
+    }
+  }
+
+  return len >= 3 ? len - 3 : 0;
+}
+
+#endif
+
+
+std::size_t rsss::scanSync(const std::uint8_t *data, std::size_t len, std::uint8_t seed, std::uint8_t alternate) {
+  const auto a = key(seed);
+  const auto b = key(alternate);
+
+#if SYNC_X86
+  static const bool avx2 = detectAvx2();
+  return avx2 ? scanAvx2(data, len, a, b) : scanSse2(data, len, a, b);
+#elif SYNC_NEON
+  return scanNeon(data, len, a, b);
+#else
+  return scanScalar(data, 0, len, a, b);
+#endif
+}
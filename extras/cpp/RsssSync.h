@@ -0,0 +1,18 @@
+#ifndef RSSS_SYNC_H
+#  define RSSS_SYNC_H
+
+#  include <cstddef>
+#  include <cstdint>
+
+
+namespace rsss {
+
+  // Offset of the first sync header in data[0, len) whose CRC8 validates
+  // against either seed. When there is none the result is the first offset
+  // that could not be ruled out, len - 3 for len >= 3, so scanning can resume
+  // there once more data has arrived. A header was found when result + 4 <= len.
+  std::size_t scanSync(const std::uint8_t *data, std::size_t len, std::uint8_t seed, std::uint8_t alternate);
+
+}
+
+#endif /* RSSS_SYNC_H */
@@ -0,0 +1,111 @@
+#include "RsssThreadPool.h"
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+
+using namespace rsss;
+
+
+ThreadPool::ThreadPool(unsigned threads):
+  workers(),
+  queue(),
+  mutex(),
+  cv(),
+  stop(false) {
+  if(!threads) {
+    auto hardware = std::thread::hardware_concurrency();
+    threads = hardware > 1 ? hardware - 1 : 0;
+  }
+
+  workers.reserve(threads);
+  while(threads-- > 0) {
+    workers.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> guard(mutex);
+    stop = true;
+  }
+  cv.notify_all();
+
+  for(auto &worker: workers) {
+    worker.join();
+  }
+}
+
+
+void ThreadPool::run(std::size_t count, std::function<void(std::size_t)> task) {
+  // helpers that only get scheduled after the work is done must find nothing
+  // left to do, so everything they touch is shared rather than on this stack
+  struct State {
+    std::function<void(std::size_t)> task;
+    std::atomic<std::size_t>         next;
+    std::size_t                      done;
+    std::mutex                       mutex;
+    std::condition_variable          cv;
+  };
+
+  auto state = std::make_shared<State>();
+  state->task = std::move(task);
+  state->next = 0;
+  state->done = 0;
+
+  auto drain = [state, count]() {
+    std::size_t finished = 0;
+    for(std::size_t i; (i = state->next++) < count; ++finished) {
+      state->task(i);
+    }
+
+    if(finished) {
+      std::unique_lock<std::mutex> guard(state->mutex);
+      if((state->done += finished) == count) {
+        state->cv.notify_all();
+      }
+    }
+  };
+
+  if(auto helpers = std::min<std::size_t>(workers.size(), count ? count - 1 : 0); helpers > 0) {
+    {
+      std::unique_lock<std::mutex> guard(mutex);
+      while(helpers-- > 0) {
+        queue.emplace_back(drain);
+      }
+    }
+    cv.notify_all();
+  }
+
+  drain();
+
+  std::unique_lock<std::mutex> guard(state->mutex);
+  state->cv.wait(guard, [&]() { return state->done == count; });
+}
+
+
+ThreadPool &ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+
+void ThreadPool::work() {
+  std::unique_lock<std::mutex> guard(mutex);
+
+  while(true) {
+    cv.wait(guard, [this]() { return stop || !queue.empty(); });
+    if(queue.empty()) {
+      return; // stopping
+    }
+
+    auto job = std::move(queue.front());
+    queue.pop_front();
+
+    guard.unlock();
+    job();
+    guard.lock();
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef RSSS_THREAD_POOL_H
+#  define RSSS_THREAD_POOL_H
+
+#  include <deque>
+#  include <mutex>
+#  include <thread>
+#  include <vector>
+#  include <cstddef>
+#  include <functional>
+#  include <condition_variable>
+
+
+namespace rsss {
+
+class ThreadPool {
+  public:
+    explicit ThreadPool(unsigned = 0); // defaults to one worker per extra hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // call task(0) .. task(count - 1) across the pool and the calling thread,
+    // returning once every call has completed
+    void run(std::size_t count, std::function<void(std::size_t)> task);
+
+    static ThreadPool &shared();
+
+  private:
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex                        mutex;
+    std::condition_variable           cv;
+    bool                              stop;
+
+    void work();
+};
+
+}
+
+
+#endif /* RSSS_THREAD_POOL_H */
@@ -26,7 +26,7 @@ bool RsssCrc::validate8(const PackedByteArray &data, int32_t seed, int32_t off)
 
 
 int32_t RsssCrc::calc16(const PackedByteArray &data, int32_t seed, int32_t off) {
-  return rsss::calcCrc16(&data.ptr()[off], data.size() - off, static_cast<uint16_t>(seed));
+  return rsss::calcCrc16Parallel(&data.ptr()[off], data.size() - off, static_cast<uint16_t>(seed));
 }
 
 
@@ -45,7 +45,7 @@ bool RsssCrc::validate16(const PackedByteArray &data, int32_t seed, int32_t off)
 
 
 int64_t RsssCrc::calc32(const PackedByteArray &data, int64_t seed, int32_t off) {
-  return rsss::calculateCrc32(&data.ptr()[off], data.size() - off, static_cast<uint32_t>(seed));
+  return rsss::calculateCrc32Parallel(&data.ptr()[off], data.size() - off, static_cast<uint32_t>(seed));
 }
 
 
@@ -63,6 +63,44 @@ bool RsssCrc::validate32(const PackedByteArray &data, int64_t seed, int32_t off)
 }
 
 
+// Only the CRC bytes are returned, so scripts can grow their own array with
+// append_array() instead of receiving a full copy from append*()
+static PackedByteArray littleEndian(int64_t value, int32_t size) {
+  PackedByteArray result;
+  result.resize(size);
+  for(int32_t i = 0; i < size; ++i) {
+    result[i] = (value >> (8 * i)) & 0xFF;
+  }
+
+  return result;
+}
+
+
+PackedByteArray RsssCrc::tail8(const PackedByteArray &data, int32_t seed, int32_t off) {
+  return littleEndian(calc8(data, seed, off), 1);
+}
+
+
+PackedByteArray RsssCrc::tail16(const PackedByteArray &data, int32_t seed, int32_t off) {
+  return littleEndian(calc16(data, seed, off), 2);
+}
+
+
+PackedByteArray RsssCrc::tail32(const PackedByteArray &data, int64_t seed, int32_t off) {
+  return littleEndian(calc32(data, seed, off), 4);
+}
+
+
+int32_t RsssCrc::combine16(int32_t first, int32_t second, int64_t len, int32_t seed) {
+  return rsss::crc16Combine(static_cast<uint16_t>(first), static_cast<uint16_t>(second), len, static_cast<uint16_t>(seed));
+}
+
+
+int64_t RsssCrc::combine32(int64_t first, int64_t second, int64_t len, int64_t seed) {
+  return rsss::crc32Combine(static_cast<uint32_t>(first), static_cast<uint32_t>(second), len, static_cast<uint32_t>(seed));
+}
+
+
 void RsssCrc::_bind_methods() {
   ClassDB::bind_static_method("RsssCrc", D_METHOD("calc8", "data", "seed", "offset"), &RsssCrc::calc8, DEFVAL(0));
   ClassDB::bind_static_method("RsssCrc", D_METHOD("append8", "data", "seed", "offset"), &RsssCrc::append8, DEFVAL(0));
@@ -75,6 +113,13 @@ void RsssCrc::_bind_methods() {
   ClassDB::bind_static_method("RsssCrc", D_METHOD("calc32", "data", "seed", "offset"), &RsssCrc::calc32, DEFVAL(0));
   ClassDB::bind_static_method("RsssCrc", D_METHOD("append32", "data", "seed", "offset"), &RsssCrc::append32, DEFVAL(0));
   ClassDB::bind_static_method("RsssCrc", D_METHOD("validate32", "data", "seed", "offset"), &RsssCrc::validate32, DEFVAL(0));
+
+  ClassDB::bind_static_method("RsssCrc", D_METHOD("tail8", "data", "seed", "offset"), &RsssCrc::tail8, DEFVAL(0));
+  ClassDB::bind_static_method("RsssCrc", D_METHOD("tail16", "data", "seed", "offset"), &RsssCrc::tail16, DEFVAL(0));
+  ClassDB::bind_static_method("RsssCrc", D_METHOD("tail32", "data", "seed", "offset"), &RsssCrc::tail32, DEFVAL(0));
+
+  ClassDB::bind_static_method("RsssCrc", D_METHOD("combine16", "first", "second", "second_length", "seed"), &RsssCrc::combine16);
+  ClassDB::bind_static_method("RsssCrc", D_METHOD("combine32", "first", "second", "second_length", "seed"), &RsssCrc::combine32);
 }
 
 
@@ -21,6 +21,11 @@ class RsssCrc: public Object {
   static int64_t         calc32(const PackedByteArray &data, int64_t seed, int32_t offset = 0);
   static PackedByteArray append32(const PackedByteArray &data, int64_t seed, int32_t offset = 0);
   static bool            validate32(const PackedByteArray &data, int64_t seed, int32_t offset = 0);
+  static PackedByteArray tail8(const PackedByteArray &data, int32_t seed, int32_t offset = 0);
+  static PackedByteArray tail16(const PackedByteArray &data, int32_t seed, int32_t offset = 0);
+  static PackedByteArray tail32(const PackedByteArray &data, int64_t seed, int32_t offset = 0);
+  static int32_t         combine16(int32_t first, int32_t second, int64_t second_length, int32_t seed);
+  static int64_t         combine32(int64_t first, int64_t second, int64_t second_length, int64_t seed);
 
 protected:
   static void _bind_methods();
@@ -0,0 +1,82 @@
+#include "CrcStream.h"
+#include "RsssCrc8.h"
+#include "RsssCrc16.h"
+#include "RsssCrc32.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+
+RsssCrcStream::RsssCrcStream():
+  width(16),
+  seed(0),
+  crc(0),
+  length(0) {
+}
+
+
+bool RsssCrcStream::start(int32_t w, int64_t s) {
+  if(w != 8 && w != 16 && w != 32) {
+    return false;
+  }
+
+  width = w;
+  crc = seed = s;
+  length = 0;
+  return true;
+}
+
+
+int64_t RsssCrcStream::update(const PackedByteArray &data, int32_t off, int32_t len) {
+  if(off < 0 || off > data.size()) {
+    return crc;
+  }
+
+  if(len < 0 || len > data.size() - off) {
+    len = data.size() - off;
+  }
+
+  // the CRC values are resumable, so feeding them back in as the seed
+  // continues the calculation without touching earlier data
+  auto ptr = &data.ptr()[off];
+  switch(width) {
+    case 8:  crc = rsss::calcCrc8(ptr, len, static_cast<uint8_t>(crc)); break;
+    case 16: crc = rsss::calcCrc16Parallel(ptr, len, static_cast<uint16_t>(crc)); break;
+    case 32: crc = rsss::calculateCrc32Parallel(ptr, len, static_cast<uint32_t>(crc)); break;
+  }
+
+  length += len;
+  return crc;
+}
+
+
+int64_t RsssCrcStream::finish() {
+  auto result = crc;
+  crc = seed;
+  length = 0;
+  return result;
+}
+
+
+PackedByteArray RsssCrcStream::finish_bytes() {
+  auto result = finish();
+
+  PackedByteArray bytes;
+  bytes.resize(width / 8);
+  for(int64_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = (result >> (8 * i)) & 0xFF;
+  }
+
+  return bytes;
+}
+
+
+void RsssCrcStream::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("start", "width", "seed"), &RsssCrcStream::start);
+  ClassDB::bind_method(D_METHOD("update", "data", "offset", "length"), &RsssCrcStream::update, DEFVAL(0), DEFVAL(-1));
+  ClassDB::bind_method(D_METHOD("finish"), &RsssCrcStream::finish);
+  ClassDB::bind_method(D_METHOD("finish_bytes"), &RsssCrcStream::finish_bytes);
+
+  ClassDB::bind_method(D_METHOD("get_width"), &RsssCrcStream::get_width);
+  ClassDB::bind_method(D_METHOD("get_value"), &RsssCrcStream::get_value);
+  ClassDB::bind_method(D_METHOD("get_length"), &RsssCrcStream::get_length);
+}
@@ -0,0 +1,36 @@
+#ifndef RSSS_CRC_STREAM_H
+#define RSSS_CRC_STREAM_H
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+
+using namespace godot;
+
+
+// incremental CRC8/CRC16/CRC32 over data fed in pieces
+class RsssCrcStream: public RefCounted {
+  GDCLASS(RsssCrcStream, RefCounted);
+
+  int32_t width;
+  int64_t seed;
+  int64_t crc;
+  int64_t length;
+
+public:
+  RsssCrcStream();
+
+  bool            start(int32_t width, int64_t seed);
+  int64_t         update(const PackedByteArray &data, int32_t offset = 0, int32_t length = -1);
+  int64_t         finish();
+  PackedByteArray finish_bytes();
+
+  int32_t get_width() const { return width; }
+  int64_t get_value() const { return crc; }
+  int64_t get_length() const { return length; }
+
+protected:
+  static void _bind_methods();
+};
+
+#endif
@@ -1,10 +1,51 @@
 #include "PacketPeerRsss.h"
 
 
+// LEB128 lengths in front of each packet of a packed region, 7 bits a byte
+// starting with the lowest, the top bit set on all but the last
+static void appendPacked(std::vector<uint8_t> &region, const uint8_t *data, int64_t size) {
+  auto value = static_cast<uint64_t>(size);
+
+  do {
+    region.push_back(static_cast<uint8_t>((value & 0x7F) | (value > 0x7F ? 0x80 : 0)));
+    value >>= 7;
+  } while(value);
+
+  region.insert(region.end(), data, data + size);
+}
+
+
+static int64_t packedSize(int64_t size) {
+  int64_t bytes = 1;
+  while(size >>= 7) {
+    ++bytes;
+  }
+
+  return bytes;
+}
+
+
+static bool readVarint(const uint8_t *&at, const uint8_t *end, int64_t &value) {
+  value = 0;
+
+  for(int shift = 0; at < end && shift < 63; shift += 7) {
+    auto byte = *at++;
+    value |= static_cast<int64_t>(byte & 0x7F) << shift;
+
+    if(!(byte & 0x80)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
 PacketPeerRsss::PacketPeerRsss():
   parser(),
-  buffer(new uint8_t[parser.maximumSync()]),
-  go(false) {
+  go(false),
+  pack_size(0),
+  pack_delay(5) {
 }
 
 
@@ -62,11 +103,11 @@ Error PacketPeerRsss::_get_packet(const uint8_t **r_buffer, int32_t* r_buffer_si
     return ERR_UNAVAILABLE;
   }
 
-  auto &packet = packets_in.front();
-  memcpy(&buffer[0], &packet.data[0], packet.size);
-  *r_buffer_size = packet.size;
-  *r_buffer = &buffer[0];
+  // hand out the received array itself, it only has to outlive the next call
+  current = std::move(packets_in.front());
   packets_in.pop_front();
+  *r_buffer_size = static_cast<int32_t>(current.size());
+  *r_buffer = current.ptr();
   return OK;
 }
 
@@ -76,7 +117,12 @@ Error PacketPeerRsss::_put_packet(const uint8_t *p_buffer, int p_buffer_size) {
     return ERR_PARAMETER_RANGE_ERROR;
   }
 
+  // checked under the lock, so packing can't be turned on in between
   std::unique_lock<std::mutex> guard(mutex_out);
+  if(pack_size > 0 && packedSize(p_buffer_size) + p_buffer_size > parser.maximumSync()) {
+    return ERR_PARAMETER_RANGE_ERROR; // packed packets have to fit in one region
+  }
+
   packets_out.emplace_back(std::make_unique<uint8_t[]>(p_buffer_size), p_buffer_size);
   memcpy(&packets_out.back().data[0], p_buffer, p_buffer_size);
   cv_out.notify_one();
@@ -84,6 +130,26 @@ Error PacketPeerRsss::_put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 }
 
 
+Error PacketPeerRsss::setPackSize(int64_t bytes) {
+  std::unique_lock<std::mutex> guard(mutex_out);
+  bytes = std::clamp<int64_t>(bytes, 0, parser.maximumSync());
+
+  // packets queued unpacked that are too large to go into a region packed
+  // have to go out first, they can't be sent either way once packing is on
+  if(bytes > 0) {
+    for(auto &packet: packets_out) {
+      if(packedSize(packet.size) + packet.size > parser.maximumSync()) {
+        return ERR_BUSY;
+      }
+    }
+  }
+
+  pack_size = bytes;
+  cv_out.notify_one();
+  return OK;
+}
+
+
 void PacketPeerRsss::readPackets() {
   std::unique_ptr<uint8_t[]> packet;
   int64_t remaining;
@@ -94,7 +160,7 @@ void PacketPeerRsss::readPackets() {
     }
 
     if((remaining = parser.readSyncRemaining()) <= 0) {
-      continue; // how does that even happen?
+      continue; // heartbeats carry nothing
     }
 
     PackedByteArray packet;
@@ -104,16 +170,40 @@ void PacketPeerRsss::readPackets() {
       if(auto result = parser.read(packet, packet.size() - remaining, remaining); result < 0) {
         break; // some kind of error
       }
+      else if(result == 0) {
+        // nothing there yet, with a frame timeout read() doesn't block
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
       else {
         remaining -= result;
       }
-    } while(remaining > 0);
+    } while(remaining > 0 && go && !parser.truncated());
 
-    // check for error state
-    if(remaining == 0) {
+    // check for error state, packets the sender never finished are dropped
+    if(remaining != 0) {
+      continue;
+    }
+
+    if(pack_size <= 0) {
       std::unique_lock<std::mutex> guard(mutex_in);
-      packets_in.emplace_back(std::make_unique<uint8_t[]>(packet.size()), packet.size());
-      memcpy(&packets_in.back().data[0], packet.ptr(), packet.size());
+      packets_in.emplace_back(std::move(packet));
+      continue;
+    }
+
+    // split a packed region, a length running past its end drops the rest
+    std::vector<PackedByteArray> unpacked;
+    const uint8_t *at = packet.ptr(), *end = at + packet.size();
+    for(int64_t size; at < end && readVarint(at, end, size) && size <= end - at; at += size) {
+      if(size > 0) {
+        unpacked.emplace_back();
+        unpacked.back().resize(size);
+        memcpy(unpacked.back().ptrw(), at, size);
+      }
+    }
+
+    std::unique_lock<std::mutex> guard(mutex_in);
+    for(auto &one: unpacked) {
+      packets_in.emplace_back(std::move(one));
     }
   }
 }
@@ -121,9 +211,54 @@ void PacketPeerRsss::readPackets() {
 
 void PacketPeerRsss::writePackets() {
   std::unique_lock<std::mutex> guard(mutex_out);
+  std::vector<uint8_t> packed; // packing mode region being filled
+  auto opened = std::chrono::steady_clock::now();
+
   while(go) {
+    if(const int64_t limit = pack_size; limit > 0 || !packed.empty()) {
+      bool full = false;
+
+      while(!packets_out.empty()) {
+        auto &next  = packets_out.front();
+        auto  entry = packedSize(next.size) + next.size;
+
+        if(!packed.empty() && static_cast<int64_t>(packed.size()) + entry > limit) {
+          full = true; // goes into the next region
+          break;
+        }
+
+        if(packed.empty()) {
+          opened = std::chrono::steady_clock::now();
+        }
+
+        appendPacked(packed, &next.data[0], next.size); // setPackSize() made sure it fits
+        packets_out.pop_front();
+      }
+
+      if(packed.empty()) {
+        idle(guard);
+        continue;
+      }
+
+      auto deadline = opened + std::chrono::milliseconds(pack_delay.load());
+      if(!full && static_cast<int64_t>(packed.size()) < limit && std::chrono::steady_clock::now() < deadline) {
+        cv_out.wait_until(guard, deadline);
+        continue; // room for more, and time to wait for it
+      }
+
+      PackedByteArray region;
+      region.resize(packed.size());
+      memcpy(region.ptrw(), packed.data(), packed.size());
+      packed.clear();
+
+      guard.unlock();
+      writePacket(region);
+      guard.lock();
+      continue;
+    }
+
     if(packets_out.empty()) {
-      cv_out.wait_for(guard, std::chrono::milliseconds(100));
+      idle(guard);
       continue;
     }
 
@@ -132,23 +267,51 @@ void PacketPeerRsss::writePackets() {
     memcpy(packet.ptrw(), &packets_out.front().data[0], packet.size());
     // release the mutex during the actuall sending of the serial data
     guard.unlock();
-
-    int64_t sent = 0;
-    do {
-      if(auto result = parser.write(packet, sent, packet.size() - sent); result < 0) {
-        break; // some kind of error
-      }
-      else {
-        sent += result;
-      }
-    } while(sent < packet.size());
+    writePacket(packet);
     guard.lock();
     packets_out.pop_front();
   }
 }
 
 
+void PacketPeerRsss::writePacket(const PackedByteArray &packet) {
+  int64_t sent = 0;
+  do {
+    if(auto result = parser.write(packet, sent, packet.size() - sent); result < 0) {
+      break; // some kind of error
+    }
+    else {
+      sent += result;
+    }
+  } while(sent < packet.size());
+}
+
+
+// nothing to send, wait for a packet and keep the heartbeat going meanwhile
+void PacketPeerRsss::idle(std::unique_lock<std::mutex> &guard) {
+  auto beat = parser.heartbeatInterval();
+  cv_out.wait_for(guard, std::chrono::milliseconds(beat > 0 ? std::min<int64_t>(beat, 100) : 100));
+  parser.tick();
+}
+
+
 void PacketPeerRsss::_bind_methods() {
   ClassDB::bind_static_method("PacketPeerRsss", D_METHOD("wrap", "stream"), &PacketPeerRsss::wrap);
+
+  ClassDB::bind_method(D_METHOD("set_frame_timeout", "msec"), &PacketPeerRsss::setFrameTimeout);
+  ClassDB::bind_method(D_METHOD("get_frame_timeout"), &PacketPeerRsss::getFrameTimeout);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_timeout"), "set_frame_timeout", "get_frame_timeout");
+
+  ClassDB::bind_method(D_METHOD("set_heartbeat", "msec"), &PacketPeerRsss::setHeartbeat);
+  ClassDB::bind_method(D_METHOD("get_heartbeat"), &PacketPeerRsss::getHeartbeat);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "heartbeat"), "set_heartbeat", "get_heartbeat");
+
+  ClassDB::bind_method(D_METHOD("set_pack_size", "bytes"), &PacketPeerRsss::setPackSize);
+  ClassDB::bind_method(D_METHOD("get_pack_size"), &PacketPeerRsss::getPackSize);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "pack_size"), "set_pack_size", "get_pack_size");
+
+  ClassDB::bind_method(D_METHOD("set_pack_delay", "msec"), &PacketPeerRsss::setPackDelay);
+  ClassDB::bind_method(D_METHOD("get_pack_delay"), &PacketPeerRsss::getPackDelay);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "pack_delay"), "set_pack_delay", "get_pack_delay");
 }
 
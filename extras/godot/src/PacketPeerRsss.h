@@ -33,10 +33,13 @@
 
 #include <deque>
 #include <mutex>
+#include <chrono>
+#include <vector>
 #include <atomic>
 #include <memory>
 #include <thread>
 #include <cstring>
+#include <algorithm>
 #include <condition_variable>
 
 #include <godot_cpp/classes/ref.hpp>
@@ -70,16 +73,18 @@ class PacketPeerRsss : public PacketPeerExtension {
     int64_t                    size;
   };
 
-  rsss::RSSS                 parser;
-  std::mutex                 mutex_in;
-  std::mutex                 mutex_out;
-  std::condition_variable    cv_out;
-  std::deque<Packet>         packets_in;
-  std::deque<Packet>         packets_out;
-  std::unique_ptr<uint8_t[]> buffer;
-  std::thread                worker_in;
-  std::thread                worker_out;
-  std::atomic_bool           go;
+  rsss::RSSS                  parser;
+  std::mutex                  mutex_in;
+  std::mutex                  mutex_out;
+  std::condition_variable     cv_out;
+  std::deque<PackedByteArray> packets_in;
+  std::deque<Packet>          packets_out;
+  PackedByteArray             current; // backs the pointer handed out by _get_packet
+  std::thread                 worker_in;
+  std::thread                 worker_out;
+  std::atomic_bool            go;
+  std::atomic<int64_t>        pack_size;  // packing is on when > 0, it must be on at both ends or neither
+  std::atomic<int64_t>        pack_delay;
 
 public:
   PacketPeerRsss();
@@ -87,6 +92,31 @@ public:
 
   static Ref<PacketPeerRsss> wrap(const Ref<StreamPeer> &stream);
 
+  void    setFrameTimeout(int64_t msec) { parser.setFrameTimeout(msec); }
+  int64_t getFrameTimeout() const { return parser.frameTimeout(); }
+
+  void    setHeartbeat(int64_t msec) { parser.setHeartbeat(msec); }
+  int64_t getHeartbeat() const { return parser.heartbeatInterval(); }
+
+  // packing: queued packets share a region, each behind a varint length, and
+  // the region goes out once the next packet would push it past pack_size
+  // bytes or once its first packet has waited pack_delay milliseconds. 0 (the
+  // default) sends one packet per region.
+  //
+  // Nothing on the wire tells a packed region from a plain one. Both ends must
+  // agree on whether packing is on, a receiver with pack_size above 0 splits
+  // every region it gets back into packets. If only one end packs, packets
+  // arrive as garbage or get dropped, silently. Switch both ends together,
+  // while the link is idle.
+  //
+  // Turning packing on fails with ERR_BUSY while packets too large to be
+  // packed are still queued; they go out unpacked first.
+  Error   setPackSize(int64_t bytes);
+  int64_t getPackSize() const { return pack_size; }
+
+  void    setPackDelay(int64_t msec) { pack_delay = std::max<int64_t>(msec, 0); cv_out.notify_one(); }
+  int64_t getPackDelay() const { return pack_delay; }
+
   int32_t _get_max_packet_size() const override;
   int32_t _get_available_packet_count() const override;
 
@@ -96,6 +126,8 @@ public:
 protected:
   void readPackets();
   void writePackets();
+  void writePacket(const PackedByteArray &);
+  void idle(std::unique_lock<std::mutex> &);
 
   bool initialize(const Ref<StreamPeer> &stream);
 
@@ -2,6 +2,8 @@
 #  define RSSS_H
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 
 #include "godot_cpp/classes/ref.hpp"
@@ -21,6 +23,20 @@ class RSSS {
     int64_t write(const godot::PackedByteArray &, int64_t, int64_t);
     bool    crcValid() const { return valid; }
 
+    // give up on a region once no byte arrived for this many milliseconds,
+    // 0 (the default) waits forever; truncated() then stays true until the
+    // next synchronization point
+    void    setFrameTimeout(int64_t ms) { timeout = ms; }
+    int64_t frameTimeout() const { return timeout; }
+    bool    truncated() const { return stalled; }
+
+    // send an empty synchronization point whenever nothing was written for
+    // this many milliseconds, 0 (the default) turns it off; heartbeats only
+    // go out from tick()
+    void    setHeartbeat(int64_t ms) { heartbeat = ms; }
+    int64_t heartbeatInterval() const { return heartbeat; }
+    int64_t tick();
+
     int64_t maximumSync() const { return 0xFFFF; }
     int64_t readSyncRemaining() const { return readSync; }
     int64_t writeSyncRemaining() const { return writeSync; }
@@ -36,11 +52,17 @@ class RSSS {
     std::uint16_t                 readSync;
     std::uint16_t                 writeCrc;
     std::uint16_t                 writeSync;
+    std::atomic<std::int64_t>     timeout;
+    std::atomic<std::int64_t>     heartbeat;
+    std::chrono::steady_clock::time_point lastByte;
+    std::chrono::steady_clock::time_point lastWrite;
     std::int8_t                   remain;
     std::uint8_t                  hold;
     bool                          addTail;
     bool                          valid;
+    bool                          stalled;
 
+    bool          abandon();
     std::uint16_t findSync();
     bool          emitSync(std::uint16_t);
 };
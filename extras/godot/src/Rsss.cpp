@@ -21,10 +21,15 @@ RSSS::RSSS( bool t):
   readSync(0),
   writeCrc(0),
   writeSync(0),
+  timeout(0),
+  heartbeat(0),
+  lastByte(),
+  lastWrite(),
   remain(0),
   hold(0),
   addTail(t),
-  valid(!t) {
+  valid(!t),
+  stalled(false) {
 }
 
 
@@ -47,6 +52,8 @@ int64_t RSSS::read(PackedByteArray &data, int64_t offset, int64_t length) {
         remain--;
       }
 
+      lastByte = std::chrono::steady_clock::now();
+
       if(!remain) {
         valid = !calcCrc16(&last[0], 2, readCrc);
         data[offset] = hold;
@@ -56,6 +63,9 @@ int64_t RSSS::read(PackedByteArray &data, int64_t offset, int64_t length) {
     else if(avail < 0) {
       return avail; // some kind of read error?
     }
+    else {
+      abandon();
+    }
 
     return 0;  // didn't read enough to validate
   }
@@ -65,21 +75,48 @@ int64_t RSSS::read(PackedByteArray &data, int64_t offset, int64_t length) {
   }
 
   if(readSync > 0) {
-    auto bytes = serial->get_data(std::min(length, static_cast<int64_t>(readSync)));
+    length = std::min(length, static_cast<int64_t>(readSync));
+
+    if(timeout > 0) {
+      // get_data() blocks until it has everything, only ask for what's there
+      if(auto avail = serial->get_available_bytes(); avail <= 0) {
+        abandon();
+        return avail < 0 ? avail : 0;
+      }
+      else {
+        length = std::min(length, static_cast<int64_t>(avail));
+      }
+    }
+
+    auto bytes = serial->get_data(length);
 
     if(auto count = bytes.size(); count == 2 && static_cast<int64_t>(bytes[0]) == 0) {
-      { PackedByteArray arr(bytes[1]);
-      memcpy(&data[offset], arr.ptr(), count = arr.size()); }
+      {
+        PackedByteArray arr(bytes[1]);
+        count = arr.size();
+
+        if(offset == 0 && count == data.size()) {
+          data = arr; // the whole packet in one go, share the array instead of copying it
+        }
+        else {
+          memcpy(&data[offset], arr.ptr(), count);
+        }
+      }
+
+      // reads below go through ptr(), and the reply lets go of its reference
+      // so the held byte written back later doesn't copy a shared array either
+      bytes.clear();
 
       if(addTail) {
-        readCrc = calcCrc16(&data[offset], count, readCrc);
+        readCrc = calcCrc16(data.ptr() + offset, count, readCrc);
       }
 
+      lastByte  = std::chrono::steady_clock::now();
       readSync -= count;
 
       if(!readSync && addTail) {
         remain = 2;
-        hold = data[count -= 1];
+        hold = data.ptr()[count -= 1];
         return count + read(data, offset + count, 1);
       }
 
@@ -115,6 +152,7 @@ int64_t RSSS::write(const PackedByteArray &data, int64_t offset, int64_t length)
 
     if(auto sent = static_cast<int64_t>(arr[1]); sent > 0) {
       if(addTail) { writeCrc = calcCrc16(&data[offset], sent, writeCrc); }
+      lastWrite = std::chrono::steady_clock::now();
 
       writeSync -= sent;
       count -= sent;
@@ -161,6 +199,7 @@ int64_t RSSS::write(const PackedByteArray &data, int64_t offset, int64_t length)
     if(auto sent = static_cast<int64_t>(arr[1]); sent > 0) {
       writeSync -= sent;
       retVal += sent;
+      lastWrite = std::chrono::steady_clock::now();
 
       if(addTail) {
         writeCrc = calcCrc16(&data[offset], sent, writeCrc);
@@ -197,22 +236,43 @@ static bool nextByte(StreamPeer *s, uint8_t *d) {
 
 
 std::uint16_t RSSS::findSync() {
-  do {
+  // only shift the window once a byte has actually arrived, an empty peer
+  // must not drop a partially received header
+  for(std::uint8_t byte; nextByte(serial.ptr(), &byte); ) {
+    memmove(&last[0], &last[1], 3);
+    last[3] = byte;
+
     if(last[0] == 0xAA && validateCrc8(&last[0], 4, CRC8_SEED)) {
       auto retVal = last[1] | (last[2] << 8);
       memset(&last[0], 0, 4);
       readCrc = CRC16_SEED;
-      valid = !addTail;
+      valid = !addTail || !retVal; // a heartbeat has no tail to check
+      stalled = false;
+      lastByte = std::chrono::steady_clock::now();
       return retVal;
     }
-
-    memmove(&last[0], &last[1], 3);
-  } while(nextByte(serial.ptr(), &last[3]));
+  }
 
   return 0;
 }
 
 
+// drop the current region once the sender went quiet for too long, so the
+// next frame isn't taken for the rest of this one
+bool RSSS::abandon() {
+  if(timeout <= 0 || std::chrono::steady_clock::now() - lastByte < std::chrono::milliseconds(timeout)) {
+    return false;
+  }
+
+  readSync = 0;
+  remain = 0;
+  hold = 0;
+  valid = false;
+  stalled = true;
+  return true;
+}
+
+
 bool RSSS::emitSync(std::uint16_t length) {
   PackedByteArray header;
   header.resize(4);
@@ -224,12 +284,23 @@ bool RSSS::emitSync(std::uint16_t length) {
 
   if(serial->put_data(header) == OK) {
     writeCrc = CRC16_SEED;
+    lastWrite = std::chrono::steady_clock::now();
     return true;
   }
 
   return false;
 }
 
+int64_t RSSS::tick() {
+  if(serial.is_null() || heartbeat <= 0 || writeSync > 0 ||
+     std::chrono::steady_clock::now() - lastWrite < std::chrono::milliseconds(heartbeat)) {
+    return 0; // not due, or inside a region where a header would be taken for payload
+  }
+
+  return emitSync(0) ? 1 : -1;
+}
+
+
 bool RSSS::waitForSync(int64_t ms) {
   if(readSync > 0) {
     return true;
@@ -0,0 +1,90 @@
+#include "RsssClmul.h"
+
+#if RSSS_CRC_CLMUL
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define CLMUL_TARGET
+#  else
+#    define CLMUL_TARGET __attribute__((target("pclmul,sse2")))
+#  endif
+#endif
+
+
+using namespace rsss;
+
+
+#if RSSS_CRC_CLMUL
+
+static bool detectClmul() {
+#  ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 1)) != 0;
+#  else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("pclmul");
+#  endif
+}
+
+
+bool rsss::hasClmul() {
+  static const bool supported = detectClmul();
+  return supported;
+}
+
+
+CLMUL_TARGET static inline __m128i fold(__m128i x, __m128i k, __m128i next) {
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                     _mm_clmulepi64_si128(x, k, 0x11)), next);
+}
+
+
+CLMUL_TARGET std::size_t rsss::foldClmul(const std::uint8_t *data, std::size_t len, std::uint32_t crc,
+                                         const ClmulConstants &k, std::uint8_t (&remainder)[16]) {
+  auto load = [](const std::uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); };
+  const auto k512 = _mm_set_epi64x(static_cast<long long>(k.fold512[1]), static_cast<long long>(k.fold512[0]));
+  const auto k128 = _mm_set_epi64x(static_cast<long long>(k.fold128[1]), static_cast<long long>(k.fold128[0]));
+  const auto *start = data;
+
+  // the reflected CRC state lines up with the first bytes of the message
+  auto x0 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+  auto x1 = load(data + 16);
+  auto x2 = load(data + 32);
+  auto x3 = load(data + 48);
+  data += 64;
+  len  -= 64;
+
+  // four independent lanes hide the multiplier latency
+  for(; len >= 64; len -= 64, data += 64) {
+    x0 = fold(x0, k512, load(data));
+    x1 = fold(x1, k512, load(data + 16));
+    x2 = fold(x2, k512, load(data + 32));
+    x3 = fold(x3, k512, load(data + 48));
+  }
+
+  x0 = fold(x0, k128, x1);
+  x0 = fold(x0, k128, x2);
+  x0 = fold(x0, k128, x3);
+
+  for(; len >= 16; len -= 16, data += 16) {
+    x0 = fold(x0, k128, load(data));
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&remainder[0]), x0);
+  return static_cast<std::size_t>(data - start);
+}
+
+#else
+
+bool rsss::hasClmul() {
+  return false;
+}
+
+
+std::size_t rsss::foldClmul(const std::uint8_t *, std::size_t, std::uint32_t,
+                            const ClmulConstants &, std::uint8_t (&)[16]) {
+  return 0;
+}
+
+#endif
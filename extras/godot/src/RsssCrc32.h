@@ -6,9 +6,18 @@
 
 namespace rsss {
 
+class ThreadPool;
+
 std::uint32_t calculateCrc32(const std::uint8_t *data, size_t length, std::uint32_t seed);
 std::uint32_t appendCrc32(std::uint8_t *data, size_t length, std::uint32_t seed);
 bool          validateCrc32(const std::uint8_t *data, size_t length, std::uint32_t seed);
 
+// merge the CRCs of two adjacent blocks that were both started from seed
+std::uint32_t crc32Combine(std::uint32_t first, std::uint32_t second, size_t secondLength, std::uint32_t seed);
+
+// split large buffers across a thread pool and combine the partial CRCs
+std::uint32_t calculateCrc32Parallel(const std::uint8_t *data, size_t length, std::uint32_t seed);
+std::uint32_t calculateCrc32Parallel(const std::uint8_t *data, size_t length, std::uint32_t seed, ThreadPool &pool);
+
 }
 
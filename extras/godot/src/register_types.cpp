@@ -31,6 +31,7 @@
 #include "register_types.h"
 
 #include "Crc.h"
+#include "CrcStream.h"
 #include "PacketPeerRsss.h"
 
 void initialize_rsss_module(ModuleInitializationLevel p_level) {
@@ -39,6 +40,7 @@ void initialize_rsss_module(ModuleInitializationLevel p_level) {
 	}
 
 	GDREGISTER_CLASS(RsssCrc);
+	GDREGISTER_CLASS(RsssCrcStream);
 	GDREGISTER_VIRTUAL_CLASS(PacketPeerRsss);
 }
 
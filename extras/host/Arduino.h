@@ -0,0 +1,16 @@
+#ifndef RSSS_HOST_ARDUINO_H
+#  define RSSS_HOST_ARDUINO_H
+
+// The Arduino core functions used by src/ besides Stream, backed by the host.
+
+#  include <chrono>
+
+
+inline unsigned long millis() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return static_cast<unsigned long>(duration_cast<milliseconds>(steady_clock::now() - start).count());
+}
+
+
+#endif /* RSSS_HOST_ARDUINO_H */
@@ -0,0 +1,64 @@
+#ifndef RSSS_HOST_MEMORY_STREAM_H
+#  define RSSS_HOST_MEMORY_STREAM_H
+
+#  include "Stream.h"
+
+#  include <cstring>
+#  include <vector>
+
+
+// Loopback Stream over a fixed size ring buffer, bytes written are the next
+// bytes read. A full buffer accepts nothing, like a full hardware TX queue.
+class MemoryStream: public Stream {
+  public:
+    explicit MemoryStream(size_t capacity = 1 << 17): _data(capacity), _head(0), _size(0) {}
+
+    int available() override { return static_cast<int>(_size); }
+    int availableForWrite() override { return static_cast<int>(_data.size() - _size); }
+
+    int read() override {
+      if(!_size) {
+        return -1;
+      }
+
+      uint8_t c = _data[_head];
+      _head = (_head + 1) % _data.size();
+      --_size;
+      return c;
+    }
+
+    int peek() override {
+      return _size ? _data[_head] : -1;
+    }
+
+    size_t write(uint8_t c) override {
+      return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      const size_t capacity = _data.size();
+      if(size > capacity - _size) {
+        size = capacity - _size;
+      }
+
+      size_t tail = (_head + _size) % capacity;
+      size_t first = size < capacity - tail ? size : capacity - tail;
+      memcpy(&_data[tail], buffer, first);
+      memcpy(&_data[0], buffer + first, size - first);
+      _size += size;
+      return size;
+    }
+
+    void clear() {
+      _head = 0;
+      _size = 0;
+    }
+
+  private:
+    std::vector<uint8_t> _data;
+    size_t _head;
+    size_t _size;
+};
+
+
+#endif /* RSSS_HOST_MEMORY_STREAM_H */
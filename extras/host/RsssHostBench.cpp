@@ -0,0 +1,126 @@
+// Host benchmarks for the Arduino RSSS class in src/ running over a
+// MemoryStream, see README.md for the build command. Any arguments restrict
+// the run to benchmarks whose name contains one of them.
+
+#include "Bench.h"
+#include "MemoryStream.h"
+
+#include "RSSS.h"
+
+#include <string>
+#include <vector>
+#include <random>
+
+
+using namespace rsss::bench;
+
+
+// frames are limited by the int16_t sync counters of the Arduino port
+static const int MAXIMUM = 0x7FFF;
+
+
+static std::vector<uint8_t> encode(bool tail, const uint8_t *data, int size) {
+  MemoryStream stream;
+  RSSS rsss(stream, tail);
+
+  rsss.write(const_cast<uint8_t *>(data), size);
+
+  std::vector<uint8_t> result(stream.available());
+  stream.readBytes(result.data(), result.size());
+  return result;
+}
+
+
+static int readFrame(RSSS &rsss, uint8_t *out, int size) {
+  int got = 0;
+
+  while(got < size) {
+    int count = rsss.read(&out[got], size - got);
+    if(count <= 0) {
+      break;
+    }
+
+    got += count;
+  }
+
+  return got;
+}
+
+
+int main(int argc, char **argv) {
+  static const struct { const char *name; bool tail; } MODES[] = {
+    { "",       false },
+    { " crc16", true  },
+  };
+
+  std::vector<uint8_t> data(MAXIMUM), out(MAXIMUM);
+  std::mt19937 rng(3);
+  for(auto &byte: data) {
+    byte = static_cast<uint8_t>(rng());
+  }
+
+  header();
+
+  for(auto &mode: MODES) {
+    std::string writeName  = std::string("write")            + mode.name;
+    std::string readName   = std::string("read")             + mode.name;
+    std::string idleName   = std::string("available idle")   + mode.name;
+    std::string syncedName = std::string("available synced") + mode.name;
+
+    MemoryStream stream;
+    RSSS rsss(stream, mode.tail);
+
+    // per call cost of polling with nothing to read, reported per call
+    if(selected(idleName.c_str(), argc, argv)) {
+      report(idleName.c_str(), 1, measure([&]() { consume(rsss.available()); }));
+    }
+
+    // per call cost of polling inside a synchronized region
+    if(selected(syncedName.c_str(), argc, argv)) {
+      const auto frame = encode(mode.tail, data.data(), 256);
+      stream.write(frame.data(), frame.size());
+      rsss.available();
+      report(syncedName.c_str(), 1, measure([&]() { consume(rsss.available()); }));
+      readFrame(rsss, out.data(), 256);
+    }
+
+    for(auto size: SIZES) {
+      if(size > static_cast<size_t>(MAXIMUM)) {
+        continue;
+      }
+
+      const int len = static_cast<int>(size);
+      const auto frame = encode(mode.tail, data.data(), len);
+
+      // one write() call emitting header, payload and tail into a drained stream
+      if(selected(writeName.c_str(), argc, argv)) {
+        report(writeName.c_str(), size, measure([&]() {
+          stream.clear();
+          consume(rsss.write(data.data(), len));
+        }));
+      }
+
+      // a whole frame through available()/read(), including the refill copy
+      if(selected(readName.c_str(), argc, argv)) {
+        bool ok = true;
+        auto sample = measure([&]() {
+          stream.clear();
+          stream.write(frame.data(), frame.size());
+          ok = readFrame(rsss, out.data(), len) == len && rsss.crcValid() && ok;
+        });
+
+        if(ok) {
+          report(readName.c_str(), size, sample);
+        }
+        else {
+          printf("%-28s %8zu failed\n", readName.c_str(), size);
+        }
+      }
+
+    }
+
+    stream.clear();
+  }
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef RSSS_HOST_STREAM_H
+#  define RSSS_HOST_STREAM_H
+
+// Subset of the Arduino Print/Stream interface needed to build src/ on a host.
+// readBytes() is built on read() the way the Arduino core does it, minus the
+// timeout, so the per byte call overhead of the firmware is preserved.
+
+#  include <stddef.h>
+#  include <stdint.h>
+
+
+class Print {
+  public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      size_t count = 0;
+      while(size-- > 0 && write(*buffer++)) {
+        ++count;
+      }
+
+      return count;
+    }
+
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+};
+
+
+class Stream: public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t *buffer, size_t length) {
+      size_t count = 0;
+      for(int c; count < length && (c = read()) >= 0; ++count) {
+        buffer[count] = static_cast<uint8_t>(c);
+      }
+
+      return count;
+    }
+
+    size_t readBytes(char *buffer, size_t length) {
+      return readBytes(reinterpret_cast<uint8_t *>(buffer), length);
+    }
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+  protected:
+    unsigned long _timeout = 1000;
+};
+
+
+#endif /* RSSS_HOST_STREAM_H */
@@ -1,3 +1,5 @@
+import time
+
 import RsssCrc8 as crc8
 import RsssCrc16 as crc16
 
@@ -15,18 +17,39 @@ class RSSS:
     self.__hold      = 0
     self.__addTail   = tail
     self.__valid     = not tail
+    self.__heartbeat = 0
+    self.__lastWrite = 0
+    self.__stage     = bytearray()
+    self.__stageSize = 0
+    self.__cadence   = 0
+    self.__stagedAt  = 0
+    self.__timeout   = 0
+    self.__lastByte  = 0
+    self.__truncated = False
 
 
   def crcValid(self):
     return self.__valid
 
 
+  # give up on a region once no byte arrived for this many seconds, 0 (the
+  # default) waits forever; truncated() then stays true until the next
+  # synchronization point
+  def setFrameTimeout(self, seconds):
+    self.__timeout = seconds
+
+
+  def truncated(self):
+    return self.__truncated
+
+
   def read(self, size=1):
     # handle optional CRC processing
     if self.__addTail and self.__remain != 0:
       b = self.__serial.read(self.__remain);
 
       if len(b) > 0:
+        self.__lastByte = time.monotonic()
         for byte in b:
           self.__crc[2 - self.__remain] = byte
           self.__remain -= 1
@@ -34,6 +57,8 @@ class RSSS:
         if self.__remain == 0:
           self.__valid = crc16.calculate(self.__crc, self.__readCrc) == 0
           return [ self.__hold ];
+      else:
+        self.__abandon()
 
       return [] # didn't read enough to validate
 
@@ -43,6 +68,11 @@ class RSSS:
     if self.__readSync > 0:
       count = size if self.__readSync > size else self.__readSync
       arr   = self.__serial.read(count)
+      if len(arr) == 0:
+        self.__abandon()
+        return []
+
+      self.__lastByte  = time.monotonic()
       self.__readSync -= len(arr)
 
       if self.__readSync == 0 and self.__addTail:
@@ -63,6 +93,9 @@ class RSSS:
 
     if size < 0:
       size = len(data)
+
+    if self.__stageSize > 0:
+      return self.__stream(data[0:size])
     count = size
     wrote = 0
 
@@ -71,6 +104,7 @@ class RSSS:
       arr = data[0:chunk]
       wrote = self.__serial.write(arr)
       if wrote > 0:
+        self.__lastWrite = time.monotonic()
         if self.__addTail:
           self.__writeCrc = crc16.calculate(arr, self.__writeCrc)
 
@@ -92,6 +126,7 @@ class RSSS:
 
       sent = self.__serial.write(data)
       if sent > 0:
+        self.__lastWrite = time.monotonic()
         self.__writeSync -= sent
         wrote += sent
         if self.__addTail:
@@ -101,10 +136,76 @@ class RSSS:
     return wrote
 
 
+  # send an empty synchronization point whenever nothing was written for this
+  # many seconds, 0 turns it off; heartbeats only go out from tick()
+  def setHeartbeat(self, seconds):
+    self.__heartbeat = seconds
+
+
+  # stream mode: instead of a region per write, written bytes are staged and
+  # sent as one region once size of them have gathered, or once the oldest
+  # has waited this many seconds (0 leaves it to the size and flush), however
+  # the caller slices its writes; size 0 turns it off. Anything staged is
+  # sent first; returns False, changing nothing, while write is inside a region
+  def setCadence(self, size, seconds = 0):
+    if self.__writeSync > 0:
+      return False # a header now would land inside the open region
+
+    self.__emitStage()
+    self.__stageSize = min(size, 0xFFFF)
+    self.__cadence   = seconds
+    return True
+
+
+  def tick(self):
+    if self.__stage and self.__cadence > 0 and time.monotonic() - self.__stagedAt >= self.__cadence:
+      self.__emitStage()
+      return 1
+
+    if self.__stage or self.__heartbeat <= 0 or self.__writeSync > 0 or time.monotonic() - self.__lastWrite < self.__heartbeat:
+      return 0 # not due, or inside a region where a header would be taken for payload
+
+    self.__emitSync(0)
+    return 1
+
+
   def flush(self):
+    self.__emitStage()
     self.__serial.flush()
 
 
+  def __stream(self, data):
+    if self.__stage and self.__cadence > 0 and time.monotonic() - self.__stagedAt >= self.__cadence:
+      self.__emitStage()
+
+    taken = 0
+    while taken < len(data):
+      if not self.__stage:
+        self.__stagedAt = time.monotonic()
+
+      count = min(len(data) - taken, self.__stageSize - len(self.__stage))
+      self.__stage += data[taken:taken + count]
+      taken += count
+
+      if len(self.__stage) == self.__stageSize:
+        self.__emitStage()
+
+    return taken
+
+
+  def __emitStage(self):
+    if not self.__stage:
+      return
+
+    self.__emitSync(len(self.__stage))
+    self.__serial.write(self.__stage)
+    if self.__addTail:
+      self.__writeCrc = crc16.calculate(self.__stage, self.__writeCrc)
+      self.__serial.write([ self.__writeCrc & 0xFF, (self.__writeCrc >> 8) & 0xFF ])
+
+    self.__stage = bytearray()
+
+
   def __findSync(self):
     while True:
       byte = self.__serial.read()
@@ -116,11 +217,29 @@ class RSSS:
       self.__last.append(byte[0])
 
       if self.__last[0] == 0xAA and crc8.validate(self.__last, crc8.SEED):
-        self.__readCrc = crc16.SEED
+        self.__readCrc   = crc16.SEED
+        self.__valid     = not self.__addTail or (self.__last[1] | self.__last[2]) == 0 # a heartbeat has no tail to check
+        self.__truncated = False
+        self.__lastByte  = time.monotonic()
         return self.__last[1] | (self.__last[2] << 8)
 
 
+  # drop the current region once the sender went quiet for too long, so the
+  # next frame isn't taken for the rest of this one
+  def __abandon(self):
+    if self.__timeout <= 0 or time.monotonic() - self.__lastByte < self.__timeout:
+      return False
+
+    self.__readSync  = 0
+    self.__remain    = 0
+    self.__hold      = 0
+    self.__valid     = False
+    self.__truncated = True
+    return True
+
+
   def __emitSync(self, length):
-    self.__writeCrc = crc16.SEED
+    self.__writeCrc  = crc16.SEED
+    self.__lastWrite = time.monotonic()
     self.__serial.write(crc8.append([ 0xAA, length & 0xFF, (length >> 8) & 0xFF ], crc8.SEED))
 
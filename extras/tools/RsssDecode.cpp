@@ -0,0 +1,104 @@
+// Offline decoder for raw captures of RSSS traffic, see README.md for the
+// build command and the options.
+
+#include "RsssCapture.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+
+using namespace rsss;
+
+using Clock = std::chrono::steady_clock;
+
+
+static const char *tailName(Tail tail) {
+  switch(tail) {
+    case Tail::Crc16:  return "crc16";
+    case Tail::Crc32c: return "crc32c";
+    default:           return "none";
+  }
+}
+
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s [-t none|crc16] [-m max-length] [-j workers] [-s] capture...\n", name);
+  return 2;
+}
+
+
+int main(int argc, char **argv) {
+  Tail     tail    = Tail::None;
+  unsigned threads = 0;
+  long     length  = 0xFFFF;
+  bool     summary = false;
+
+  for(int opt; (opt = getopt(argc, argv, "t:m:j:s")) != -1;) {
+    switch(opt) {
+      case 't':
+        if(!strcmp(optarg, "crc16")) {
+          tail = Tail::Crc16;
+        }
+        else if(strcmp(optarg, "none")) {
+          return usage(argv[0]); // CRC32C regions are marked in their header
+        }
+        break;
+
+      case 'm':
+        length = strtol(optarg, nullptr, 0);
+        if(length < 1 || length > 0xFFFF) {
+          return usage(argv[0]);
+        }
+        break;
+
+      case 'j':
+        threads = static_cast<unsigned>(atoi(optarg));
+        break;
+
+      case 's':
+        summary = true;
+        break;
+
+      default:
+        return usage(argv[0]);
+    }
+  }
+
+  if(optind >= argc) {
+    return usage(argv[0]);
+  }
+
+  ThreadPool pool(threads);
+  int        status = 0;
+
+  for(int i = optind; i < argc; ++i) {
+    Capture capture(argv[i]);
+    if(!capture.ok()) {
+      fprintf(stderr, "%s: %s\n", argv[i], strerror(capture.err()));
+      status = 1;
+      continue;
+    }
+
+    auto start  = Clock::now();
+    auto frames = capture.decode(tail, static_cast<std::uint16_t>(length), pool);
+    auto took   = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::size_t valid = 0, invalid = 0, truncated = 0;
+    for(auto &frame: frames) {
+      if(!summary) {
+        printf("%12llu %5u %-6s %s\n", static_cast<unsigned long long>(frame.offset), frame.length, tailName(frame.tail),
+               frame.truncated ? "truncated" : frame.valid ? "ok" : "bad");
+      }
+
+      frame.truncated ? ++truncated : frame.valid ? ++valid : ++invalid;
+    }
+
+    fprintf(summary ? stdout : stderr, "%s: %zu frames, %zu ok, %zu bad, %zu truncated, %zu bytes in %.3f s (%.1f MB/s)\n",
+            argv[i], frames.size(), valid, invalid, truncated, capture.size(), took, capture.size() / took / 1e6);
+  }
+
+  return status;
+}
@@ -1,3 +1,5 @@
+#include <Arduino.h>
+
 #include "RSSS.h"
 #include "RsssCrc8.h"
 #include "RsssCrc16.h"
@@ -16,17 +18,28 @@ RSSS::RSSS(Stream &s, bool tail):
   _readSync(0),
   _writeCrc(0),
   _writeSync(0),
+  _lastByte(0),
+  _lastWrite(0),
+  _timeout(0),
+  _heartbeat(0),
+  _stage(nullptr),
+  _stageSize(0),
+  _staged(0),
+  _cadence(0),
+  _stagedAt(0),
   _remain(0),
   _hold(0),
   _addTail(tail),
-  _valid(!tail) {
+  _valid(!tail),
+  _truncated(false) {
   memset(&_last[0], 0, sizeof(_last));
 }
 
 
 int RSSS::available(void) {
   if(_remain > 0) {
-    return 1; // allow the held byte to count while looking for tail bytes
+    // allow the held byte to count while looking for tail bytes
+    return _serial->available() < _remain && _stalled() ? 0 : 1;
   }
 
   if(_readSync <= 0) {
@@ -37,6 +50,10 @@ int RSSS::available(void) {
   // was a synchronization point was found?
   if(_readSync > 0) {
     int avail = _serial->available();
+    if(avail == 0 && _stalled()) {
+      return 0;
+    }
+
     return _readSync <= avail ? _readSync : avail;
   }
 
@@ -54,6 +71,7 @@ int RSSS::read(uint8_t *buffer, int max) {
 
       if(count > 0) {
         _readCrc = rsss::calcCrc16(&buf[0], count, _readCrc);
+        _lastByte = millis();
 
         if(!(_remain -= count)) {
           _valid = !_readCrc;
@@ -63,6 +81,9 @@ int RSSS::read(uint8_t *buffer, int max) {
         }
       }
     }
+    else {
+      _stalled();
+    }
 
     return 0; // didn't read enough to validate
   }
@@ -76,6 +97,8 @@ int RSSS::read(uint8_t *buffer, int max) {
   if(max > 0) {
     int count = _serial->readBytes(buffer, max);
     if(count > 0) {
+      _lastByte = millis();
+
       if(_addTail) {
         _readCrc = rsss::calcCrc16(buffer, count, _readCrc);
       }
@@ -100,6 +123,68 @@ bool RSSS::crcValid(void) {
 }
 
 
+void RSSS::setFrameTimeout(uint16_t ms) {
+  _timeout = ms;
+}
+
+
+bool RSSS::truncated(void) {
+  return _truncated;
+}
+
+
+void RSSS::setHeartbeat(uint16_t ms) {
+  _heartbeat = ms;
+}
+
+
+bool RSSS::setCadence(uint8_t *buffer, int16_t size, uint16_t ms) {
+  if(_writeSync > 0) {
+    return false; // a header now would land inside the open region
+  }
+
+  flush();
+
+  _stage = size > 0 ? buffer : nullptr;
+  _stageSize = _stage ? size : 0;
+  _staged = 0;
+  _cadence = ms;
+  return true;
+}
+
+
+void RSSS::flush(void) {
+  if(_staged > 0) {
+    _emitSync(_staged);
+    _serial->write(_stage, _staged);
+
+    if(_addTail) {
+      _writeCrc = rsss::calcCrc16(_stage, _staged, _writeCrc);
+      uint8_t buffer[2] = { static_cast<uint8_t>( _writeCrc       & 0xFF),
+                            static_cast<uint8_t>((_writeCrc >> 8) & 0xFF) };
+      _serial->write(&buffer[0], 2); // write the tail bytes
+    }
+
+    _staged = 0;
+  }
+}
+
+
+int RSSS::tick(void) {
+  if(_staged > 0 && _cadence && millis() - _stagedAt >= _cadence) {
+    flush();
+    return 1;
+  }
+
+  if(_staged > 0 || !_heartbeat || _writeSync > 0 || millis() - _lastWrite < _heartbeat) {
+    return 0; // not due, or inside a region where a header would be taken for payload
+  }
+
+  _emitSync(0);
+  return 1;
+}
+
+
 int RSSS::availableForWrite(void) {
   int avail = _serial->availableForWrite();
 
@@ -117,6 +202,10 @@ int RSSS::availableForWrite(void) {
 
 
 int RSSS::write(uint8_t *data, int length) {
+  if(_stage) {
+    return _stream(data, length);
+  }
+
   //int avail = availableForWrite();
   int count = length;// <= avail ? length : avail;
   int retVal = 0;
@@ -130,6 +219,8 @@ int RSSS::write(uint8_t *data, int length) {
   if(_writeSync > 0) {
     int sent = _serial->write(data, count >= _writeSync ? _writeSync : count);
     if(sent > 0) {
+      _lastWrite = millis();
+
       // update the written CRC if required
       if(_addTail) { _writeCrc = rsss::calcCrc16(data, sent, _writeCrc); }
 
@@ -164,6 +255,7 @@ int RSSS::write(uint8_t *data, int length) {
     // write data
     int sent = _serial->write(data, count);
     if(sent > 0) {
+      _lastWrite = millis();
       _writeSync -= sent;
       retVal += sent;
       if(_addTail) {
@@ -194,6 +286,33 @@ failure:
 }
 
 
+// stage bytes until a whole region of them is there, or the oldest has
+// waited for the cadence, and send them as one region
+int RSSS::_stream(uint8_t *data, int length) {
+  if(_staged > 0 && _cadence && millis() - _stagedAt >= _cadence) {
+    flush();
+  }
+
+  int taken = 0;
+  while(taken < length) {
+    if(!_staged) {
+      _stagedAt = millis();
+    }
+
+    int count = length - taken < _stageSize - _staged ? length - taken : _stageSize - _staged;
+    memcpy(&_stage[_staged], &data[taken], count);
+    _staged += count;
+    taken += count;
+
+    if(_staged == _stageSize) {
+      flush();
+    }
+  }
+
+  return taken;
+}
+
+
 int16_t RSSS::_findSync() {
   while(_serial->available() > 0) {
     _last[0] = _last[1];
@@ -202,7 +321,9 @@ int16_t RSSS::_findSync() {
     _last[3] = _serial->read();
 
     if(_last[0] == 0xAA && rsss::validateCrc8(&_last[0], 4, CRC8_SEED)) {
-      _valid = !_addTail;
+      _valid = !_addTail || !(_last[1] | _last[2]); // a heartbeat has no tail to check
+      _truncated = false;
+      _lastByte = millis();
       _readCrc = CRC16_SEED;
       return _last[1] | (_last[2] << 8);
     }
@@ -212,10 +333,27 @@ int16_t RSSS::_findSync() {
 }
 
 
+// drop the current region once the sender went quiet for too long, so the
+// next frame isn't taken for the rest of this one
+bool RSSS::_stalled(void) {
+  if(!_timeout || millis() - _lastByte < _timeout) {
+    return false;
+  }
+
+  _readSync = 0;
+  _remain = 0;
+  _hold = 0;
+  _valid = false;
+  _truncated = true;
+  return true;
+}
+
+
 void RSSS::_emitSync(int16_t len) {
   uint8_t packet[4] = { 0xAA, (uint8_t) (len & 0xFF), (uint8_t) ((len >> 8) & 0xFF), 0 };
   rsss::appendCrc8(&packet[0], 3, CRC8_SEED);
   _serial->write(&packet[0], sizeof(packet));
   _writeCrc = CRC16_SEED;
+  _lastWrite = millis();
 }
 
@@ -4,6 +4,26 @@
 #  include <Stream.h>
 
 
+// Storage used for the CRC8 and CRC16 lookup tables. The full tables cost
+// 768 bytes, which AVR parts copy into SRAM unless they are kept in flash.
+//   RAM    - 256 entry tables in RAM, the fastest option
+//   FLASH  - 256 entry tables left in flash and read with pgm_read_*
+//   NIBBLE - 16 entry tables in RAM (48 bytes), two lookups per byte
+// The speed of FLASH and NIBBLE on AVR hasn't been measured, estimated from
+// the instruction set both are slower than RAM, NIBBLE the slowest
+#  define RSSS_CRC_TABLE_RAM    0
+#  define RSSS_CRC_TABLE_FLASH  1
+#  define RSSS_CRC_TABLE_NIBBLE 2
+
+#  ifndef RSSS_CRC_TABLE
+#    ifdef __AVR__
+#      define RSSS_CRC_TABLE RSSS_CRC_TABLE_FLASH
+#    else
+#      define RSSS_CRC_TABLE RSSS_CRC_TABLE_RAM
+#    endif
+#  endif
+
+
 class RSSS {
   public:
     RSSS(Stream &s, bool = false);
@@ -12,9 +32,31 @@ class RSSS {
     int  read(uint8_t *, int);
     bool crcValid();
 
+    // give up on a region once no byte arrived for this many milliseconds,
+    // 0 (the default) waits forever; truncated() then stays true until the
+    // next synchronization point
+    void setFrameTimeout(uint16_t);
+    bool truncated();
+
     int availableForWrite(void);
     int write(uint8_t *, int);  // write a data chunk and emit a synchronization point as needed
 
+    // send an empty synchronization point whenever nothing was written for
+    // this many milliseconds, 0 (the default) turns it off; heartbeats only
+    // go out from tick(), call it from loop()
+    void setHeartbeat(uint16_t);
+    int  tick(void);
+
+    // stream mode: instead of a region per write(), written bytes are staged
+    // in buffer and sent as one region once size of them have gathered, or
+    // once the oldest has waited ms milliseconds, however the sketch slices
+    // its writes. With ms = 0 only the size and flush() send them, otherwise
+    // write() and tick() check the time too. A null buffer (the default)
+    // turns it off. Anything staged is sent first; returns false, changing
+    // nothing, while write() is inside a region
+    bool setCadence(uint8_t *, int16_t, uint16_t = 0);
+    void flush(void); // send the staged bytes now
+
   private:
     Stream  *_serial;
     uint8_t  _last[4];
@@ -22,12 +64,24 @@ class RSSS {
     int16_t  _readSync;
     uint16_t _writeCrc;
     int16_t  _writeSync;
+    uint32_t _lastByte;
+    uint32_t _lastWrite;
+    uint16_t _timeout;
+    uint16_t _heartbeat;
+    uint8_t *_stage;
+    int16_t  _stageSize;
+    int16_t  _staged;
+    uint16_t _cadence;
+    uint32_t _stagedAt;
     int8_t   _remain;
     uint8_t  _hold;
     bool     _addTail;
     bool     _valid;
+    bool     _truncated;
 
+    bool    _stalled();
     int16_t _findSync();
+    int     _stream(uint8_t *, int);
     void _emitSync(int16_t);
 };
 
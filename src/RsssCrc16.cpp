@@ -1,8 +1,48 @@
+#include "RSSS.h"
 #include "RsssCrc16.h"
 
+#if RSSS_CRC_TABLE == RSSS_CRC_TABLE_FLASH && defined(__AVR__)
+#  include <avr/pgmspace.h>
+#  define TABLE_STORAGE  PROGMEM
+#  define TABLE_ENTRY(i) pgm_read_word(&TABLE[i])
+#else
+#  define TABLE_STORAGE
+#  define TABLE_ENTRY(i) TABLE[i]
+#endif
 
 
-static const uint16_t TABLE[256] = {
+// slicing-by-8 trades 3.5 KiB of extra tables for fewer dependent lookups,
+// which is a win on hosts but not on small AVR parts. From C++14 on the
+// tables are built at compile time and stay in flash with the code, before
+// that they would be built at startup and take the RAM, so slicing is left
+// off by default there
+#if __cplusplus >= 201402L
+#  define SLICES_CONSTEXPR constexpr
+#else
+#  define SLICES_CONSTEXPR
+#endif
+
+#if RSSS_CRC_TABLE != RSSS_CRC_TABLE_RAM
+#  undef  RSSS_CRC16_SLICING
+#  define RSSS_CRC16_SLICING 0 // slices are derived from the byte table in RAM
+#elif !defined(RSSS_CRC16_SLICING)
+#  if defined(__AVR__) || __cplusplus < 201402L
+#    define RSSS_CRC16_SLICING 0
+#  else
+#    define RSSS_CRC16_SLICING 1
+#  endif
+#endif
+
+#define SLICE_MINIMUM 32
+
+
+#if RSSS_CRC_TABLE == RSSS_CRC_TABLE_NIBBLE
+static const uint16_t NIBBLES[16] = {
+  0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+  0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F
+};
+#else
+static const SLICES_CONSTEXPR uint16_t TABLE[256] TABLE_STORAGE = {
   0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
   0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
   0x1081, 0x0108, 0x3393, 0x221A, 0x56A5, 0x472C, 0x75B7, 0x643E,
@@ -36,15 +76,68 @@ static const uint16_t TABLE[256] = {
   0xF78F, 0xE606, 0xD49D, 0xC514, 0xB1AB, 0xA022, 0x92B9, 0x8330,
   0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78
 };
+#endif
 
 
-uint16_t rsss::calcCrc16(const uint8_t *data, int len, uint16_t crc) {
+#if RSSS_CRC16_SLICING
+namespace {
+
+// table[n][i] is the CRC of byte i followed by n + 1 zero bytes
+struct Slices {
+  uint16_t table[7][256];
+
+  SLICES_CONSTEXPR Slices(): table() {
+    for(int i = 0; i < 256; ++i) {
+      uint16_t crc = TABLE[i];
+      for(int j = 0; j < 7; ++j) {
+        crc = table[j][i] = TABLE[crc & 0xFF] ^ (crc >> 8);
+      }
+    }
+  }
+};
+
+SLICES_CONSTEXPR const Slices SLICES;
+
+}
+
+
+static uint16_t sliceBy8(const uint8_t *data, int len, uint16_t crc) {
+  const auto &t = SLICES.table;
+
+  for(; len >= 8; len -= 8, data += 8) {
+    crc ^= data[0] | (data[1] << 8);
+    crc = t[6][crc & 0xFF] ^ t[5][crc >> 8] ^ t[4][data[2]] ^ t[3][data[3]] ^
+          t[2][data[4]]    ^ t[1][data[5]]  ^ t[0][data[6]] ^ TABLE[data[7]];
+  }
+
   while(len-- > 0) {
     crc = TABLE[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
   }
 
   return crc;
 }
+#endif
+
+
+uint16_t rsss::calcCrc16(const uint8_t *data, int len, uint16_t crc) {
+#if RSSS_CRC16_SLICING
+  if(len >= SLICE_MINIMUM) {
+    return sliceBy8(data, len, crc);
+  }
+#endif
+
+  while(len-- > 0) {
+#if RSSS_CRC_TABLE == RSSS_CRC_TABLE_NIBBLE
+    crc ^= *data++;
+    crc = NIBBLES[crc & 0x0F] ^ (crc >> 4);
+    crc = NIBBLES[crc & 0x0F] ^ (crc >> 4);
+#else
+    crc = TABLE_ENTRY((crc ^ *data++) & 0xFF) ^ (crc >> 8);
+#endif
+  }
+
+  return crc;
+}
 
 
 uint16_t rsss::appendCrc16(uint8_t *data, int len, uint16_t crc) {
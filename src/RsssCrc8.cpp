@@ -1,7 +1,23 @@
+#include "RSSS.h"
 #include "RsssCrc8.h"
 
+#if RSSS_CRC_TABLE == RSSS_CRC_TABLE_FLASH && defined(__AVR__)
+#  include <avr/pgmspace.h>
+#  define TABLE_STORAGE  PROGMEM
+#  define TABLE_ENTRY(i) pgm_read_byte(&TABLE[i])
+#else
+#  define TABLE_STORAGE
+#  define TABLE_ENTRY(i) TABLE[i]
+#endif
 
-static const uint8_t TABLE[256] = {
+
+#if RSSS_CRC_TABLE == RSSS_CRC_TABLE_NIBBLE
+static const uint8_t NIBBLES[16] = {
+  0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8,
+  0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
+#else
+static const uint8_t TABLE[256] TABLE_STORAGE = {
   0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83,
   0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
   0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E,
@@ -35,11 +51,18 @@ static const uint8_t TABLE[256] = {
   0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7,
   0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35,
 };
+#endif
 
 
 uint8_t rsss::calcCrc8(const uint8_t *data, int len, uint8_t crc) {
   while(len-- > 0) {
-    crc = TABLE[crc ^ *data++];
+#if RSSS_CRC_TABLE == RSSS_CRC_TABLE_NIBBLE
+    crc ^= *data++;
+    crc = NIBBLES[crc & 0x0F] ^ (crc >> 4);
+    crc = NIBBLES[crc & 0x0F] ^ (crc >> 4);
+#else
+    crc = TABLE_ENTRY(crc ^ *data++);
+#endif
   }
 
   return crc;